@@ -1,9 +1,13 @@
 #include "abstractchartwidget.h"
+#include "seriesrollup.h"
 
 #include <QtMath>
+#include <QtConcurrent>
 #include <QLabel>
 #include <QDebug>
 
+#include <limits>
+
 using namespace QtCharts;
 
 class ChartLegendItem: public QWidget
@@ -12,6 +16,7 @@ public:
     struct Legend {
         QColor color;
         QString title;
+        QString toolTip;
     };
 
     ChartLegendItem(const QString &title, QWidget *parent = Q_NULLPTR)
@@ -45,7 +50,10 @@ public:
         square->setPalette(plt);
 
         mLegendsLayout->insertWidget(mLegendsLayout->count()-1, square);
-        mLegendsLayout->insertWidget(mLegendsLayout->count()-1, new QLabel(l.title));
+        auto label = new QLabel(l.title);
+        label->setToolTip(l.toolTip);
+
+        mLegendsLayout->insertWidget(mLegendsLayout->count()-1, label);
         mLegendsLayout->insertSpacing(mLegendsLayout->count()-1, 10);
     }
 
@@ -86,25 +94,85 @@ AbstractChartWidget::~AbstractChartWidget()
 
 void AbstractChartWidget::setPoints(const QList<SeriesUnit> &activities)
 {
-    mPoints = activities;
+    // Rollups are built once per data set, durations then reuse them
+    setPoints(activities, buildRollups(activities));
 }
 
-void AbstractChartWidget::reload()
+void AbstractChartWidget::setPoints(const QList<SeriesUnit> &points, const Rollups &rollups)
 {
-    clearSeries();
+    mPoints = points;
+    mRollups = rollups;
+}
+
+const QList<AbstractChartWidget::SeriesUnit> &AbstractChartWidget::points() const
+{
+    return mPoints;
+}
+
+const AbstractChartWidget::Rollups &AbstractChartWidget::rollups() const
+{
+    return mRollups;
+}
+
+AbstractChartWidget::Rollups AbstractChartWidget::buildRollups(const QList<SeriesUnit> &points)
+{
+    std::function<std::shared_ptr<const SeriesRollup>(const SeriesUnit&)> build = [](const SeriesUnit &p){
+        return std::make_shared<SeriesRollup>(p.points);
+    };
+    const auto list = QtConcurrent::blockingMapped<QList<std::shared_ptr<const SeriesRollup>>>(points, build);
+
+    Rollups res;
+    for (qint32 i=0; i<points.count(); i++)
+        res[points.at(i).uniqueId] = list.at(i);
+    return res;
+}
 
-    qreal maxValue = 0;
-    auto minDate = QDateTime::currentDateTime();
-    auto maxDate = QDateTime(QDate(1,1,1), QTime(0,0,0));
+AbstractChartWidget::PlotData AbstractChartWidget::computePlot(const QList<SeriesUnit> &points, const Rollups &rollups, Duration duration,
+                                                               const QDateTime &startDate, const QDateTime &endDate, bool stackable)
+{
+    const auto startTime = (startDate.isValid()? startDate.toSecsSinceEpoch() : std::numeric_limits<qint64>::min());
+    const auto endTime = (endDate.isValid()? endDate.toSecsSinceEpoch() : std::numeric_limits<qint64>::max());
+
+    // Every series has its own rollup, so they are bucketed in parallel.
+    // The reduction runs in series order and doesn't depend on scheduling.
+    std::function<SeriesData(const SeriesUnit&)> compute = [&rollups, duration, startTime, endTime, stackable](const SeriesUnit &p){
+        auto rollup = rollups.value(p.uniqueId);
+        if (!rollup)
+            rollup = std::make_shared<SeriesRollup>(p.points);
+
+        return computeSeries(p, *rollup, duration, startTime, endTime, stackable);
+    };
 
-    for (const auto &p: mPoints)
+    PlotData res;
+    res.series = QtConcurrent::blockingMapped<QList<SeriesData>>(points, compute);
+    res.minDate = QDateTime::currentDateTime();
+    res.maxDate = QDateTime(QDate(1,1,1), QTime(0,0,0));
+    for (const auto &s: res.series)
     {
-        auto s = addSeries(p);
-        maxValue = std::max(maxValue, s.maxValue);
-        minDate = std::min(minDate, s.minDate);
-        maxDate = std::max(maxDate, s.maxDate);
+        res.maxValue = std::max(res.maxValue, s.maxValue);
+        res.minDate = std::min(res.minDate, s.minDate);
+        res.maxDate = std::max(res.maxDate, s.maxDate);
     }
 
+    return res;
+}
+
+void AbstractChartWidget::reload()
+{
+    applyPlot(computePlot(mPoints, mRollups, mDuration, mStartDate, mEndDate, mStackable));
+}
+
+void AbstractChartWidget::applyPlot(const PlotData &plot)
+{
+    clearSeries();
+
+    for (const auto &s: plot.series)
+        addSeries(s);
+
+    const auto maxValue = plot.maxValue;
+    const auto &minDate = plot.minDate;
+    const auto &maxDate = plot.maxDate;
+
     auto chart = mChart->chart();
 
     mAxisY = new QValueAxis(this);
@@ -137,6 +205,9 @@ void AbstractChartWidget::reload()
 
         ChartLegendItem::Legend lgn;
         lgn.title = s.unit.title;
+        lgn.toolTip = tr("Total: %1").arg(s.total, 0, 'f', 0);
+        if (s.unit.note.length())
+            lgn.toolTip += QStringLiteral("\n") + s.unit.note;
         lgn.color = s.series->color();
 
         legend->addLegend(lgn);
@@ -168,67 +239,47 @@ void AbstractChartWidget::setStackable(bool newStackable)
     mStackable = newStackable;
 }
 
-AbstractChartWidget::SeriesType AbstractChartWidget::addSeries(const SeriesUnit &unit)
+AbstractChartWidget::SeriesData AbstractChartWidget::computeSeries(const SeriesUnit &unit, const SeriesRollup &rollup, Duration duration, qint64 startTime, qint64 endTime, bool stackable)
 {
-    removeSeries(unit.uniqueId);
-
-    std::map<QDateTime, qreal> durationMap;
-    const auto currentDate = QDate::currentDate();
-    const auto add_days = currentDate.daysInYear() - currentDate.dayOfYear();
-    for (const auto &a: unit.points)
-    {
-        if (a.datetime < mStartDate)
-            continue;
-        if (a.datetime > mEndDate)
-            continue;
-
-        const auto date = a.datetime.date();
-        switch (static_cast<int>(mDuration))
-        {
-        case Day:
-            durationMap[a.datetime] += a.value;
-            break;
-        case Week:
-        {
-            auto dt = QDate::fromJulianDay(std::floor(date.toJulianDay() / 7) * 7 + 7);
-            durationMap[QDateTime(dt, QTime(0,0,0))] += a.value;
-        }
-            break;
-        case Month:
-            durationMap[QDateTime(QDate(date.year(), date.month(), 1).addMonths(1).addDays(-1), QTime(0,0,0))] += a.value;
-            break;
-        case Year:
-            durationMap[QDateTime(QDate(date.addDays(add_days).year()+1, 1, 1).addDays(-1), QTime(0,0,0))] += a.value;
-            break;
-        }
-    }
+    const auto buckets = rollup.buckets(duration, startTime, endTime);
 
-    AbstractChartWidget::SeriesType s;
+    SeriesData s;
     s.unit = unit;
     s.maxValue = 0;
-    s.minDate = QDateTime::currentDateTime();
-    s.maxDate = QDateTime(QDate(1,1,1), QTime(0,0,0));
-
-    s.series = (mSplineMode? new QSplineSeries(this) : new QLineSeries(this));
-    s.series->setName(unit.uniqueId);
-    if (unit.color.isValid())
-        s.series->setColor(unit.color);
+    s.total = rollup.total(startTime, endTime);
+    s.minDate = (buckets.isEmpty()? QDateTime::currentDateTime() : buckets.first().date);
+    s.maxDate = (buckets.isEmpty()? QDateTime(QDate(1,1,1), QTime(0,0,0)) : buckets.last().date);
 
-    qreal stack = 0;
-    for (const auto &[k, v]: durationMap)
+    // Cumulative values come from the prefix sums of the rollup
+    s.points.reserve(buckets.count());
+    for (const auto &b: buckets)
     {
-        if (!mStackable)
-            stack = v;
-        else
-            stack += v;
-
-        s.minDate = std::min(s.minDate, k);
-        s.maxDate = std::max(s.maxDate, k);
+        const auto stack = (stackable? b.total : b.value);
         s.maxValue = std::max(s.maxValue, stack);
-        s.series->append(k.toMSecsSinceEpoch(), stack);
+        s.points << QPointF(b.date.toMSecsSinceEpoch(), stack);
     }
 
-    mSeriesHash[unit.uniqueId] = s;
+    return s;
+}
+
+AbstractChartWidget::SeriesType AbstractChartWidget::addSeries(const SeriesData &data)
+{
+    removeSeries(data.unit.uniqueId);
+
+    AbstractChartWidget::SeriesType s;
+    s.unit = data.unit;
+    s.maxValue = data.maxValue;
+    s.total = data.total;
+    s.minDate = data.minDate;
+    s.maxDate = data.maxDate;
+
+    s.series = (mSplineMode? new QSplineSeries(this) : new QLineSeries(this));
+    s.series->setName(data.unit.uniqueId);
+    if (data.unit.color.isValid())
+        s.series->setColor(data.unit.color);
+    s.series->replace(data.points);
+
+    mSeriesHash[data.unit.uniqueId] = s;
     return s;
 }
 
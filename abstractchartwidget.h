@@ -9,6 +9,11 @@
 #include <QLineSeries>
 #include <QDateTimeAxis>
 #include <QValueAxis>
+#include <QPointF>
+
+#include <memory>
+
+class SeriesRollup;
 
 class AbstractChartWidget : public QWidget
 {
@@ -16,7 +21,7 @@ class AbstractChartWidget : public QWidget
 public:
     struct PointValue {
         qreal value = 0;
-        QDateTime datetime;
+        qint64 time = 0;
     };
 
     enum Duration {
@@ -30,10 +35,29 @@ public:
         QString uniqueId;
         QString category;
         QString title;
+        QString note;
         QColor color;
-        QList<AbstractChartWidget::PointValue> points;
+        QVector<AbstractChartWidget::PointValue> points;
+    };
+
+    struct SeriesData {
+        SeriesUnit unit;
+        QVector<QPointF> points;
+        qreal maxValue = 0;
+        qreal total = 0;
+        QDateTime minDate;
+        QDateTime maxDate;
     };
 
+    struct PlotData {
+        QList<SeriesData> series;
+        qreal maxValue = 0;
+        QDateTime minDate;
+        QDateTime maxDate;
+    };
+
+    typedef QHash<QString, std::shared_ptr<const SeriesRollup>> Rollups;
+
     AbstractChartWidget(QWidget *parent = nullptr);
     virtual ~AbstractChartWidget();
 
@@ -52,6 +76,10 @@ public:
     bool splineMode() const;
     void setSplineMode(bool newSplineMode);
 
+    static Rollups buildRollups(const QList<SeriesUnit> &points);
+    static PlotData computePlot(const QList<SeriesUnit> &points, const Rollups &rollups, Duration duration,
+                                const QDateTime &startDate, const QDateTime &endDate, bool stackable);
+
 public Q_SLOTS:
     void setPoints(const QList<SeriesUnit> &points);
     virtual void reload();
@@ -67,6 +95,7 @@ private:
     struct SeriesType {
         QtCharts::QLineSeries *series = Q_NULLPTR;
         qreal maxValue = 0;
+        qreal total = 0;
         QDateTime minDate;
         QDateTime maxDate;
         SeriesUnit unit;
@@ -80,6 +109,7 @@ private:
     Duration mDuration = Month;
 
     QList<SeriesUnit> mPoints;
+    Rollups mRollups;
 
     QDateTime mStartDate;
     QDateTime mEndDate;
@@ -91,7 +121,13 @@ private:
     bool mSplineMode = false;
 
 protected:
-    SeriesType addSeries(const SeriesUnit &unit);
+    static SeriesData computeSeries(const SeriesUnit &unit, const SeriesRollup &rollup, Duration duration, qint64 startTime, qint64 endTime, bool stackable);
+
+    const QList<SeriesUnit> &points() const;
+    const Rollups &rollups() const;
+    void setPoints(const QList<SeriesUnit> &points, const Rollups &rollups);
+    void applyPlot(const PlotData &plot);
+    SeriesType addSeries(const SeriesData &data);
     void clearSeries();
     void removeSeries(const QString &category);
 };
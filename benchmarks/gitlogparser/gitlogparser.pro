@@ -0,0 +1,14 @@
+QT -= gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = gitlogparser-benchmark
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../gitlogparser.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../gitlogparser.h
@@ -0,0 +1,152 @@
+#include "gitlogparser.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QRegExp>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/*!
+ * Throughput of GitLogParser against the QRegExp parsing it replaced.
+ * The log of a repository is recorded once in both output formats, then
+ * parsed from memory a few rounds and the best round is reported.
+ *
+ *   gitlogparser-benchmark <repository> [rounds]
+ */
+
+namespace {
+const qint32 chunkSize = 64 * 1024;
+
+QByteArray record(const QString &path, const QStringList &arguments)
+{
+    QProcess p;
+    p.setWorkingDirectory(path);
+    p.start(QStringLiteral("git"), arguments);
+    p.waitForFinished(-1);
+    return p.readAllStandardOutput();
+}
+
+// Header and numstat parsing of git log and git diff --numstat output
+// exactly as GitCommands did it before GitLogParser.
+qint32 parseBefore(const QByteArray &log, const QByteArray &stats)
+{
+    QList<GitCommands::Commit> commits;
+    {
+        const auto data = QString::fromUtf8(log);
+
+        QRegExp rx("commit\\s+(.+)\\s+Author\\:\\s+(.+)\\s+Date\\:\\s+(.+)\\n\\n\\s+(.+)\\n\\n");
+        rx.setMinimal(true);
+
+        int pos = 0;
+        while ((pos = rx.indexIn(data, pos)) != -1)
+        {
+            GitCommands::Commit c;
+            c.id = rx.cap(1).remove(QRegExp("Merge\\:.+")).trimmed();
+            c.commiter = rx.cap(2).trimmed();
+            c.datetime = QDateTime::fromString(rx.cap(3).trimmed(), QStringLiteral("yyyy-MM-dd hh:mm:ss"));
+            c.comment = rx.cap(4).trimmed();
+
+            commits << c;
+            pos += rx.matchedLength();
+        }
+    }
+
+    QList<GitCommands::Stat> list;
+    {
+        const auto data = QString::fromUtf8(stats);
+
+        QRegExp rx("(\\d+)\\s+(\\d+)\\s+(.+)\\n");
+        rx.setMinimal(true);
+
+        int pos = 0;
+        while ((pos = rx.indexIn(data, pos)) != -1)
+        {
+            GitCommands::Stat c;
+            c.insertions = rx.cap(1).trimmed().toInt();
+            c.deletions = rx.cap(2).trimmed().toInt();
+            c.fileName = rx.cap(3).trimmed();
+
+            list << c;
+            pos += rx.matchedLength();
+        }
+    }
+
+    return commits.count();
+}
+
+// Fed in pipe sized chunks, like GitCommands::streamLog does
+qint32 parseAfter(const QByteArray &log)
+{
+    GitLogParser parser;
+    qint32 res = 0;
+    for (qint32 i=0; i<log.size(); i+=chunkSize)
+    {
+        parser.feed(log.mid(i, chunkSize));
+        res += parser.take().count();
+    }
+
+    parser.finish();
+    res += parser.take().count();
+    return res;
+}
+
+qreal bestSeconds(qint32 rounds, std::function<void()> round)
+{
+    auto res = std::numeric_limits<qreal>::max();
+    for (qint32 i=0; i<rounds; i++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        round();
+        res = std::min(res, timer.nsecsElapsed() / 1e9);
+    }
+    return res;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const auto args = app.arguments();
+    if (args.count() < 2)
+    {
+        out << "Usage: gitlogparser-benchmark <repository> [rounds]\n";
+        return 1;
+    }
+
+    const auto path = args.at(1);
+    const auto rounds = (args.count() > 2? std::max(1, args.at(2).toInt()) : 5);
+
+    const auto before = record(path, {QStringLiteral("log"), QStringLiteral("--date=format:%Y-%m-%d %H:%M:%S")});
+    const auto beforeStats = record(path, {QStringLiteral("log"), QStringLiteral("--numstat"), QStringLiteral("--diff-merges=first-parent"), QStringLiteral("--format=")});
+    const auto after = record(path, {QStringLiteral("log"), QStringLiteral("--numstat"), QStringLiteral("--diff-merges=first-parent"),
+                                     QStringLiteral("--format=") + GitLogParser::format()});
+    if (after.isEmpty())
+    {
+        out << "No git log output in " << path << "\n";
+        return 1;
+    }
+
+    qint32 beforeCount = 0;
+    qint32 afterCount = 0;
+    const auto beforeSecs = bestSeconds(rounds, [&](){ beforeCount = parseBefore(before, beforeStats); });
+    const auto afterSecs = bestSeconds(rounds, [&](){ afterCount = parseAfter(after); });
+
+    const auto mb = [](qint64 bytes){ return bytes / (1024.0 * 1024.0); };
+    const auto beforeBytes = before.size() + beforeStats.size();
+
+    out << "commits: " << afterCount << " (QRegExp matched " << beforeCount << ")\n";
+    out << QStringLiteral("QRegExp:      %1 MB in %2 s, %3 MB/s, %4 commits/s\n")
+           .arg(mb(beforeBytes), 0, 'f', 1).arg(beforeSecs, 0, 'f', 3)
+           .arg(mb(beforeBytes) / beforeSecs, 0, 'f', 1).arg(beforeCount / beforeSecs, 0, 'f', 0);
+    out << QStringLiteral("GitLogParser: %1 MB in %2 s, %3 MB/s, %4 commits/s\n")
+           .arg(mb(after.size()), 0, 'f', 1).arg(afterSecs, 0, 'f', 3)
+           .arg(mb(after.size()) / afterSecs, 0, 'f', 1).arg(afterCount / afterSecs, 0, 'f', 0);
+    return 0;
+}
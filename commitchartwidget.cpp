@@ -1,70 +1,117 @@
 #include "commitchartwidget.h"
+#include "seriesrollup.h"
 
 #include <QtMath>
 #include <QDir>
 #include <QCryptographicHash>
 #include <QImageWriter>
 #include <QJsonDocument>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
 
 using namespace QtCharts;
 
 CommitChartWidget::CommitChartWidget(QWidget *parent)
     : AbstractChartWidget(parent)
 {
-    mGit = new GitCommands(this);
+    mOptions.maximumJobs = std::max(1, QThread::idealThreadCount());
+
+    mReloadWatcher = new QFutureWatcher<ReloadResult>(this);
+    connect(mReloadWatcher, &QFutureWatcher<ReloadResult>::finished, this, &CommitChartWidget::applyReload);
 }
 
 CommitChartWidget::~CommitChartWidget()
 {
+    mReloadWatcher->waitForFinished();
 }
 
 void CommitChartWidget::load(const QString &path)
 {
-    mGit->setPath(path);
-    mGit->listCommits([path, this](const QList<GitCommands::Commit> &list){
-        Q_EMIT loading(true, 0, list.count());
-        loadCommits(path, list);
-    });
+    auto session = mSessions.value(path);
+    if (!session)
+    {
+        session = new RepositorySession(path, this);
+        connect(session, &RepositorySession::progress, this, &CommitChartWidget::updateProgress);
+        connect(session, &RepositorySession::finished, this, &CommitChartWidget::finished);
+        mSessions[path] = session;
+    }
 
-    Q_EMIT loading(true, 0, 0);
+    session->load(mOptions);
 }
 
-void CommitChartWidget::remove(const QString &path)
+void CommitChartWidget::cancel(const QString &path)
 {
-    mAnalizeds.remove(path);
-    reload();
+    auto session = mSessions.value(path);
+    if (session)
+        session->cancel();
 }
 
-void CommitChartWidget::loadCommits(const QString &fileName, const QList<GitCommands::Commit> &list)
+void CommitChartWidget::remove(const QString &path)
 {
-    if (list.isEmpty())
+    auto session = mSessions.take(path);
+    if (session)
     {
-        finished();
-        Q_EMIT loading(false, 0, 0);
-        return;
+        session->disconnect(this);
+        delete session;
     }
 
-    const auto c = list.first();
-    mGit->commitStat(c.id, [c, this, list, fileName](const QList<GitCommands::Stat> &stats){
-        AnalizedCommit a;
-        a.commit = c;
-        a.totalFiles = stats.count();
+    invalidatePoints();
+    updateProgress();
+    reload();
+}
 
-        for (const auto &s: stats)
-        {
-            a.deletions += s.deletions;
-            a.insertions += s.insertions;
-        }
+bool CommitChartWidget::isLoading(const QString &path) const
+{
+    auto session = mSessions.value(path);
+    return session && session->isLoading();
+}
 
-        mAnalizeds[fileName] << a;
+qint32 CommitChartWidget::loadingCount() const
+{
+    qint32 res = 0;
+    for (auto s: mSessions)
+        if (s->isLoading())
+            res++;
+    return res;
+}
 
-        Q_EMIT loading(true, mAnalizeds.count(), mAnalizeds.count() + list.count() - 1);
-        loadCommits(fileName, list.mid(1));
-    });
+void CommitChartWidget::updateProgress()
+{
+    // A reload still being aggregated keeps the loading state, so the
+    // chart is complete once loading(false) is emitted.
+    bool state = mReloadWatcher->isRunning();
+    qint32 done = 0;
+    qint32 total = 0;
+    bool unknownTotal = false;
+    for (auto s: mSessions)
+    {
+        if (!s->isLoading())
+            continue;
+
+        state = true;
+        done += s->done();
+        total += s->total();
+        if (s->total() == 0)
+            unknownTotal = true;
+    }
+
+    mLoadingState = state;
+    mProgressPending = false;
+    Q_EMIT loading(state, done, unknownTotal? 0 : total);
+}
+
+void CommitChartWidget::invalidatePoints()
+{
+    mDataVersion++;
 }
 
 void CommitChartWidget::finished()
 {
+    // New rows are found by the reload and merged into the shown points
+    mProgressPending = true;
     reload();
 }
 
@@ -96,22 +143,37 @@ bool CommitChartWidget::saveJson(const QString &path)
 
     QVariantList list;
 
-    QHashIterator<QString, QList<AnalizedCommit>> i(mAnalizeds);
+    QHashIterator<QString, RepositorySession*> i(mSessions);
     while (i.hasNext())
     {
         i.next();
+        const auto &t = i.value()->table();
+        const auto statLevel = i.value()->statLevel();
 
+        // Values the repository was loaded without are left out
         QVariantList commits;
-        for (const auto &a: i.value())
+        for (qint32 r=0; r<t.count(); r++)
         {
             QVariantMap c;
-            c[QStringLiteral("commiter")] = a.commit.commiter;
-            c[QStringLiteral("comment")] = a.commit.comment;
-            c[QStringLiteral("datetime")] = a.commit.datetime;
-            c[QStringLiteral("id")] = a.commit.id;
-            c[QStringLiteral("deletions")] = a.deletions;
-            c[QStringLiteral("insertions")] = a.insertions;
-            c[QStringLiteral("total_files")] = a.totalFiles;
+            if (statLevel >= RepositorySession::NoStats)
+            {
+                c[QStringLiteral("commiter")] = t.authorName(t.author(r));
+                c[QStringLiteral("comment")] = t.comment(r);
+            }
+            c[QStringLiteral("datetime")] = t.datetime(r);
+            c[QStringLiteral("id")] = t.id(r);
+            if (statLevel >= RepositorySession::LineStats)
+            {
+                // Commits over the diff timeout only have their files counted
+                c[QStringLiteral("approximate")] = t.approximate(r);
+                if (!t.approximate(r))
+                {
+                    c[QStringLiteral("deletions")] = t.deletions(r);
+                    c[QStringLiteral("insertions")] = t.insertions(r);
+                }
+            }
+            if (statLevel >= RepositorySession::FileStats)
+                c[QStringLiteral("total_files")] = t.totalFiles(r);
 
             commits << c;
         }
@@ -136,25 +198,33 @@ bool CommitChartWidget::saveCSV(const QString &path)
 
     QString data;
 
-    QHashIterator<QString, QList<AnalizedCommit>> i(mAnalizeds);
+    QHashIterator<QString, RepositorySession*> i(mSessions);
     while (i.hasNext())
     {
         i.next();
+        const auto &t = i.value()->table();
+        const auto details = (i.value()->statLevel() >= RepositorySession::NoStats);
+        const auto files = (i.value()->statLevel() >= RepositorySession::FileStats);
+        const auto lines = (i.value()->statLevel() >= RepositorySession::LineStats);
         if (!data.isEmpty())
             data += QStringLiteral("\n");
 
-        data += QStringLiteral("%1,Commiter,Date/Time,Comment,Total Files,Insertions,Deletions\n").arg(i.key());
+        data += QStringLiteral("%1,Commiter,Date/Time,Comment,Total Files,Insertions,Deletions,Approximate\n").arg(i.key());
 
-        for (const auto &a: i.value())
+        // Cells of values the repository was loaded without stay empty, and
+        // so do line counts of commits over the diff timeout.
+        for (qint32 r=0; r<t.count(); r++)
         {
-            data += QStringLiteral("%1,%2,%3,%4,%5,%6,%7\n")
-                    .arg(a.commit.id)
-                    .arg(a.commit.commiter)
-                    .arg(a.commit.datetime.toString("yyyy/MM/dd hh:mm:ss"))
-                    .arg(a.commit.comment)
-                    .arg(a.totalFiles)
-                    .arg(a.insertions)
-                    .arg(a.deletions);
+            const auto rowLines = (lines && !t.approximate(r));
+            data += QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8\n")
+                    .arg(t.id(r))
+                    .arg(details? t.authorName(t.author(r)) : QString())
+                    .arg(t.datetime(r).toString("yyyy/MM/dd hh:mm:ss"))
+                    .arg(details? t.comment(r) : QString())
+                    .arg(files? QString::number(t.totalFiles(r)) : QString())
+                    .arg(rowLines? QString::number(t.insertions(r)) : QString())
+                    .arg(rowLines? QString::number(t.deletions(r)) : QString())
+                    .arg(lines? QString::number(t.approximate(r)? 1 : 0) : QString());
         }
     }
 
@@ -175,117 +245,421 @@ CommitChartWidget::ViewType CommitChartWidget::viewType() const
 
 void CommitChartWidget::setViewType(ViewType newViewType)
 {
+    if (mViewType != newViewType)
+        invalidatePoints();
     mViewType = newViewType;
+    updateStatLevel();
 }
 
 void CommitChartWidget::reload()
 {
-    QHash<QString, AbstractChartWidget::SeriesUnit> points;
+    // Requests made while a reload is running are coalesced into a
+    // single reload started once it is done.
+    if (mReloadWatcher->isRunning())
+    {
+        mReloadPending = true;
+        return;
+    }
 
-    mMinDate = QDateTime::currentDateTime();
-    mMaxDate = QDateTime(QDate(1,1,1), QTime(0,0,0));
+    startReload();
+}
 
-    QHashIterator<QString, QList<AnalizedCommit>> i(mAnalizeds);
+void CommitChartWidget::startReload()
+{
+    // Series only change with the tables, the view or the data type.
+    // Anything else (e.g. the duration) is served from the rollups.
+    // The worker gets implicitly shared copies of everything it reads.
+    ReloadResult current;
+    current.version = mDataVersion;
+    current.approximates = mApproximates;
+    current.points = points();
+    current.rollups = rollups();
+    current.minDate = mMinDate;
+    current.maxDate = mMaxDate;
+
+    // Rows appended since the shown points were built are merged into
+    // them. A table cleared or shrunk since, or another view or data
+    // type, needs a full rebuild.
+    auto rebuild = (mPointsVersion != mDataVersion);
+    QList<TableSlice> tables;
+    QHashIterator<QString, RepositorySession*> i(mSessions);
     while (i.hasNext())
     {
         i.next();
-        QDir inf(i.key());
-        const auto fileName = inf.dirName();
+        const auto &t = i.value()->table();
+        const auto last = mIngested.value(i.key());
+        if (mIngested.contains(i.key()) && (last.generation != i.value()->generation() || last.rows > t.count()))
+            rebuild = true;
+
+        current.ingested[i.key()] = Ingested{i.value()->generation(), t.count()};
+        tables << TableSlice{i.key(), t, last.rows};
+    }
 
-        for (const auto &a: i.value())
+    if (rebuild)
+    {
+        current.approximates.clear();
+        for (auto &t: tables)
+            t.firstRow = 0;
+    }
+    else
+    {
+        tables.erase(std::remove_if(tables.begin(), tables.end(), [](const TableSlice &t){ return t.firstRow >= t.table.count(); }), tables.end());
+    }
+
+    current.updated = (rebuild || tables.count());
+
+    const auto viewType = mViewType;
+    const auto dataType = mDataType;
+    const auto duration = this->duration();
+    const auto startDate = this->startDate();
+    const auto endDate = this->endDate();
+    mReloadWatcher->setFuture(QtConcurrent::run([current, tables, rebuild, viewType, dataType, duration, startDate, endDate]() {
+        auto res = current;
+        if (rebuild)
+        {
+            res.points = buildPoints(tables, viewType, dataType, res.minDate, res.maxDate, res.approximates);
+            res.rollups = buildRollups(res.points);
+        }
+        else if (tables.count())
         {
-            mMinDate = std::min(mMinDate, a.commit.datetime);
-            mMaxDate = std::max(mMaxDate, a.commit.datetime);
+            QDateTime minDate, maxDate;
+            const auto added = buildPoints(tables, viewType, dataType, minDate, maxDate, res.approximates);
+            mergePoints(res, added, minDate, maxDate);
+        }
 
-            PointValue p;
+        // Invalid dates leave that end of the range open
+        res.plot = computePlot(res.points, res.rollups, duration, startDate, endDate, true);
+        return res;
+    }));
+}
 
-            switch (static_cast<int>(mViewType))
-            {
-            case ViewType::ViewCommiters:
+void CommitChartWidget::mergePoints(ReloadResult &res, const QList<SeriesUnit> &added, const QDateTime &minDate, const QDateTime &maxDate)
+{
+    // Only rollups of series with new points are rebuilt, from their
+    // previous daily bins rather than from every point.
+    QHash<QString, qint32> indexes;
+    for (qint32 i=0; i<res.points.count(); i++)
+        indexes[res.points.at(i).uniqueId] = i;
+
+    for (const auto &u: added)
+    {
+        const auto idx = indexes.value(u.uniqueId, -1);
+        const auto base = res.rollups.value(u.uniqueId);
+        if (idx < 0)
+        {
+            res.points << u;
+            res.rollups[u.uniqueId] = std::make_shared<SeriesRollup>(u.points);
+            continue;
+        }
+
+        auto &p = res.points[idx];
+        p.points << u.points;
+        p.note = u.note;
+        res.rollups[u.uniqueId] = (base? std::make_shared<SeriesRollup>(*base, u.points) : std::make_shared<SeriesRollup>(p.points));
+    }
+
+    res.minDate = std::min(res.minDate, minDate);
+    res.maxDate = std::max(res.maxDate, maxDate);
+}
+
+void CommitChartWidget::applyReload()
+{
+    // Reloads run one at a time, so a finished one is never older than
+    // the plot on screen. It is shown even when newer requests wait, and
+    // those are coalesced into the next reload started below.
+    const auto res = mReloadWatcher->result();
+    if (res.updated)
+    {
+        setPoints(res.points, res.rollups);
+        mPointsVersion = res.version;
+        mIngested = res.ingested;
+        mApproximates = res.approximates;
+        mMinDate = res.minDate;
+        mMaxDate = res.maxDate;
+    }
+
+    setStackable(true);
+    applyPlot(res.plot);
+
+    if (mReloadPending)
+    {
+        mReloadPending = false;
+        startReload();
+    }
+
+    if (mProgressPending || mLoadingState)
+        updateProgress();
+}
+
+QString CommitChartWidget::approximateNote(qint32 count)
+{
+    if (count == 0)
+        return QString();
+
+    return QStringLiteral("%1 commit(s) over the diff timeout have no line counts").arg(count);
+}
+
+QList<AbstractChartWidget::SeriesUnit> CommitChartWidget::buildPoints(const QList<TableSlice> &tables, ViewType viewType, DataType dataType,
+                                                                      QDateTime &minDate, QDateTime &maxDate, QHash<QString, qint32> &approximates)
+{
+    QHash<QString, AbstractChartWidget::SeriesUnit> points;
+    QHash<QString, qint32> counts;
+
+    auto minTime = std::numeric_limits<qint64>::max();
+    auto maxTime = std::numeric_limits<qint64>::min();
+
+    for (const auto &i: tables)
+    {
+        QDir inf(i.path);
+        const auto fileName = inf.dirName();
+        const auto &t = i.table;
+        const auto first = i.firstRow;
+
+        const auto &times = t.times();
+        const auto &insertions = t.insertions();
+        const auto &deletions = t.deletions();
+        const auto &totalFiles = t.totalFiles();
+        const auto &approximate = t.approximate();
+        const auto &authors = t.authors();
+
+        for (qint32 r=first; r<t.count(); r++)
+        {
+            minTime = std::min(minTime, times.at(r));
+            maxTime = std::max(maxTime, times.at(r));
+        }
+
+        switch (static_cast<int>(viewType))
+        {
+        case ViewType::ViewCommiters:
+        {
+            QVector<AbstractChartWidget::SeriesUnit> units(t.authorsCount());
+            QVector<qint32> authorApproximates(t.authorsCount());
+            for (qint32 r=first; r<t.count(); r++)
             {
-                p.datetime = a.commit.datetime;
+                PointValue p;
+                p.time = times.at(r);
+                if (approximate.at(r))
+                    authorApproximates[authors.at(r)]++;
 
-                switch (static_cast<int>(mDataType))
+                switch (static_cast<int>(dataType))
                 {
                 case DataType::Changes:
-                    p.value = a.insertions + a.deletions;
+                    p.value = insertions.at(r) + deletions.at(r);
                     break;
 
                 case DataType::Files:
-                    p.value = a.totalFiles;
+                    p.value = totalFiles.at(r);
+                    break;
+
+                case DataType::Commits:
+                    p.value = 1;
                     break;
                 }
 
-                auto &s = points[fileName + QStringLiteral("\n") + a.commit.commiter];
-                s.title = a.commit.commiter;
+                units[authors.at(r)].points << p;
+            }
+
+            for (qint32 a=0; a<units.count(); a++)
+            {
+                if (units.at(a).points.isEmpty())
+                    continue;
+
+                const auto key = fileName + QStringLiteral("\n") + t.authorName(a);
+                auto &s = points[key];
+                s.title = t.authorName(a);
                 s.category = fileName;
-                s.points << p;
+                s.points << units.at(a).points;
+                if (dataType == DataType::Changes)
+                    counts[key] += authorApproximates.at(a);
             }
-                break;
+        }
+            break;
 
-            case ViewType::ViewOverall:
+        case ViewType::ViewOverall:
+        {
+            switch (static_cast<int>(dataType))
             {
-                switch (static_cast<int>(mDataType))
-                {
-                case DataType::Changes:
+            case DataType::Changes:
+            {
+                auto &s0 = points[ fileName + QStringLiteral("\ninsertions") ];
+                s0.title = QStringLiteral("Insertions");
+                s0.category = fileName;
+
+                auto &s1 = points[ fileName + QStringLiteral("\ndeletions") ];
+                s1.title = QStringLiteral("Deletions");
+                s1.category = fileName;
+
+                auto &s2 = points[ fileName + QStringLiteral("\ntotal") ];
+                s2.title = QStringLiteral("Total");
+                s2.category = fileName;
+
+                qint32 changeApproximates = 0;
+                for (qint32 r=first; r<t.count(); r++)
                 {
-                    p.datetime = a.commit.datetime;
-                    p.value = a.insertions;
+                    PointValue p;
+                    p.time = times.at(r);
+                    if (approximate.at(r))
+                        changeApproximates++;
 
-                    auto &s0 = points[ fileName + QStringLiteral("\ninsertions") ];
-                    s0.title = QStringLiteral("Insertions");
-                    s0.category = fileName;
+                    p.value = insertions.at(r);
                     s0.points << p;
 
-                    p.datetime = a.commit.datetime;
-                    p.value = a.deletions;
-
-                    auto &s1 = points[ fileName + QStringLiteral("\ndeletions") ];
-                    s1.title = QStringLiteral("Deletions");
-                    s1.category = fileName;
+                    p.value = deletions.at(r);
                     s1.points << p;
 
-                    p.datetime = a.commit.datetime;
-                    p.value = a.insertions + a.deletions;
-
-                    auto &s2 = points[ fileName + QStringLiteral("\ntotal") ];
-                    s2.title = QStringLiteral("Total");
-                    s2.category = fileName;
+                    p.value = insertions.at(r) + deletions.at(r);
                     s2.points << p;
                 }
-                    break;
 
-                case DataType::Files:
-                {
-                    p.datetime = a.commit.datetime;
-                    p.value = a.totalFiles;
+                counts[fileName + QStringLiteral("\ninsertions")] += changeApproximates;
+                counts[fileName + QStringLiteral("\ndeletions")] += changeApproximates;
+                counts[fileName + QStringLiteral("\ntotal")] += changeApproximates;
+            }
+                break;
 
-                    auto &s = points[ fileName + QStringLiteral("\nfiles") ];
-                    s.title = QStringLiteral("Files");
-                    s.category = fileName;
+            case DataType::Files:
+            {
+                auto &s = points[ fileName + QStringLiteral("\nfiles") ];
+                s.title = QStringLiteral("Files");
+                s.category = fileName;
+
+                for (qint32 r=first; r<t.count(); r++)
+                {
+                    PointValue p;
+                    p.time = times.at(r);
+                    p.value = totalFiles.at(r);
                     s.points << p;
                 }
-                    break;
+            }
+                break;
+
+            case DataType::Commits:
+            {
+                auto &s = points[ fileName + QStringLiteral("\ncommits") ];
+                s.title = QStringLiteral("Commits");
+                s.category = fileName;
+
+                for (qint32 r=first; r<t.count(); r++)
+                {
+                    PointValue p;
+                    p.time = times.at(r);
+                    p.value = 1;
+                    s.points << p;
                 }
             }
                 break;
             }
         }
+            break;
+        }
     }
 
-    setStartDate(mMinDate);
-    setEndDate(mMaxDate);
-    setStackable(true);
+    minDate = (minTime <= maxTime? QDateTime::fromSecsSinceEpoch(minTime) : QDateTime::currentDateTime());
+    maxDate = (minTime <= maxTime? QDateTime::fromSecsSinceEpoch(maxTime) : QDateTime(QDate(1,1,1), QTime(0,0,0)));
 
+    // Counts of approximate commits add up across merged builds
     QList<AbstractChartWidget::SeriesUnit> units;
-    for (auto p: points)
+    QHashIterator<QString, AbstractChartWidget::SeriesUnit> i(points);
+    while (i.hasNext())
     {
+        i.next();
+        auto p = i.value();
         p.uniqueId = QCryptographicHash::hash((p.category + "\n" + p.title).toUtf8(), QCryptographicHash::Md5).toHex();
+
+        auto &count = approximates[p.uniqueId];
+        count += counts.value(i.key());
+        p.note = approximateNote(count);
         units << p;
     }
-    setPoints(units);
+    return units;
+}
+
+CommitChartWidget::IngestionMode CommitChartWidget::ingestionMode() const
+{
+    return mOptions.ingestionMode;
+}
 
-    AbstractChartWidget::reload();
+void CommitChartWidget::setIngestionMode(IngestionMode newIngestionMode)
+{
+    mOptions.ingestionMode = newIngestionMode;
+}
+
+CommitChartWidget::HistoryMode CommitChartWidget::historyMode() const
+{
+    return mOptions.history;
+}
+
+void CommitChartWidget::setHistoryMode(HistoryMode newHistoryMode)
+{
+    mOptions.history = newHistoryMode;
+}
+
+qint32 CommitChartWidget::maximumJobs() const
+{
+    return mOptions.maximumJobs;
+}
+
+void CommitChartWidget::setMaximumJobs(qint32 newMaximumJobs)
+{
+    mOptions.maximumJobs = std::max(1, newMaximumJobs);
+}
+
+QDateTime CommitChartWidget::loadSince() const
+{
+    return mOptions.since;
+}
+
+QDateTime CommitChartWidget::loadUntil() const
+{
+    return mOptions.until;
+}
+
+void CommitChartWidget::setLoadRange(const QDateTime &since, const QDateTime &until)
+{
+    mOptions.since = since;
+    mOptions.until = until;
+}
+
+QStringList CommitChartWidget::includePaths() const
+{
+    return mOptions.includePaths;
+}
+
+QStringList CommitChartWidget::excludePaths() const
+{
+    return mOptions.excludePaths;
+}
+
+void CommitChartWidget::setPathFilters(const QStringList &include, const QStringList &exclude)
+{
+    mOptions.includePaths = include;
+    mOptions.excludePaths = exclude;
+}
+
+GitCommands::DiffOptions CommitChartWidget::diffOptions() const
+{
+    return mOptions.diffOptions;
+}
+
+void CommitChartWidget::setDiffOptions(const GitCommands::DiffOptions &newDiffOptions)
+{
+    mOptions.diffOptions = newDiffOptions;
+}
+
+bool CommitChartWidget::exportDetails() const
+{
+    return mExportDetails;
+}
+
+void CommitChartWidget::setExportDetails(bool newExportDetails)
+{
+    mExportDetails = newExportDetails;
+    updateStatLevel();
+}
+
+QStringList CommitChartWidget::paths() const
+{
+    return mSessions.keys();
 }
 
 CommitChartWidget::DataType CommitChartWidget::dataType() const
@@ -295,5 +669,29 @@ CommitChartWidget::DataType CommitChartWidget::dataType() const
 
 void CommitChartWidget::setDataType(DataType newDataType)
 {
+    if (mDataType != newDataType)
+        invalidatePoints();
     mDataType = newDataType;
+    updateStatLevel();
+}
+
+void CommitChartWidget::updateStatLevel()
+{
+    // Commit counts don't need any diff, nor authors in the overall view
+    // unless they are exported, and file counts only need trees.
+    // Repositories loaded with less detailed stats are loaded again.
+    auto statLevel = RepositorySession::LineStats;
+    if (mDataType == Commits && mViewType == ViewOverall && !mExportDetails)
+        statLevel = RepositorySession::TimesOnly;
+    else if (mDataType == Commits)
+        statLevel = RepositorySession::NoStats;
+    else if (mDataType == Files)
+        statLevel = RepositorySession::FileStats;
+    if (statLevel == mOptions.statLevel)
+        return;
+
+    mOptions.statLevel = statLevel;
+    for (auto s: mSessions)
+        if (s->statLevel() < statLevel)
+            s->load(mOptions);
 }
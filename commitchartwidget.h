@@ -2,6 +2,7 @@
 #define COMMITCHARTWIDGET_H
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <QWidget>
 #include <QChartView>
 #include <QVBoxLayout>
@@ -9,21 +10,13 @@
 #include <QValueAxis>
 #include <QSplineSeries>
 
-#include "gitcommands.h"
 #include "abstractchartwidget.h"
+#include "repositorysession.h"
 
 class CommitChartWidget : public AbstractChartWidget
 {
     Q_OBJECT
 public:
-    struct AnalizedCommit {
-        GitCommands::Commit commit;
-
-        qint32 insertions = 0;
-        qint32 deletions = 0;
-        qint32 totalFiles = 0;
-    };
-
     enum ViewType {
         ViewOverall = 0,
         ViewCommiters = 1,
@@ -32,13 +25,20 @@ public:
     enum DataType {
         Changes = 0,
         Files = 1,
+        Commits = 2,
     };
 
+    typedef RepositorySession::IngestionMode IngestionMode;
+    typedef RepositorySession::HistoryMode HistoryMode;
+
     CommitChartWidget(QWidget *parent = nullptr);
     virtual ~CommitChartWidget();
 
     void load(const QString &path);
+    void cancel(const QString &path);
     void remove(const QString &path);
+    bool isLoading(const QString &path) const;
+    qint32 loadingCount() const;
 
     DataType dataType() const;
     void setDataType(DataType newDataType);
@@ -46,6 +46,31 @@ public:
     ViewType viewType() const;
     void setViewType(ViewType newViewType);
 
+    IngestionMode ingestionMode() const;
+    void setIngestionMode(IngestionMode newIngestionMode);
+
+    HistoryMode historyMode() const;
+    void setHistoryMode(HistoryMode newHistoryMode);
+
+    qint32 maximumJobs() const;
+    void setMaximumJobs(qint32 newMaximumJobs);
+
+    QDateTime loadSince() const;
+    QDateTime loadUntil() const;
+    void setLoadRange(const QDateTime &since, const QDateTime &until);
+
+    QStringList includePaths() const;
+    QStringList excludePaths() const;
+    void setPathFilters(const QStringList &include, const QStringList &exclude);
+
+    GitCommands::DiffOptions diffOptions() const;
+    void setDiffOptions(const GitCommands::DiffOptions &newDiffOptions);
+
+    bool exportDetails() const;
+    void setExportDetails(bool newExportDetails);
+
+    QStringList paths() const;
+
     virtual void reload() Q_DECL_OVERRIDE;
 
     const QDateTime &minDate() const;
@@ -60,15 +85,57 @@ Q_SIGNALS:
     void loading(bool state, qint32 done, qint32 total);
 
 protected:
-    void loadCommits(const QString &fileName, const QList<GitCommands::Commit> &list);
+    struct Ingested {
+        qint32 generation = 0;
+        qint32 rows = 0;
+    };
+
+    struct TableSlice {
+        QString path;
+        CommitTable table;
+        qint32 firstRow = 0;
+    };
+
+    struct ReloadResult {
+        qint32 version = 0;
+        bool updated = false;
+        QHash<QString, Ingested> ingested;
+        QHash<QString, qint32> approximates;
+        QList<SeriesUnit> points;
+        Rollups rollups;
+        QDateTime minDate;
+        QDateTime maxDate;
+        PlotData plot;
+    };
+
+    static QString approximateNote(qint32 count);
+    static QList<SeriesUnit> buildPoints(const QList<TableSlice> &tables, ViewType viewType, DataType dataType,
+                                         QDateTime &minDate, QDateTime &maxDate, QHash<QString, qint32> &approximates);
+    static void mergePoints(ReloadResult &res, const QList<SeriesUnit> &added, const QDateTime &minDate, const QDateTime &maxDate);
+
+    void startReload();
+    void applyReload();
+    void updateProgress();
+    void updateStatLevel();
+    void invalidatePoints();
     void finished();
 
 private:
-    GitCommands *mGit = Q_NULLPTR;
-    QHash<QString, QList<AnalizedCommit>> mAnalizeds;
+    QHash<QString, RepositorySession*> mSessions;
+    RepositorySession::Options mOptions;
 
     DataType mDataType = Changes;
     ViewType mViewType = ViewOverall;
+    bool mExportDetails = false;
+
+    qint32 mDataVersion = 1;
+    qint32 mPointsVersion = 0;
+    QHash<QString, Ingested> mIngested;
+    QHash<QString, qint32> mApproximates;
+    QFutureWatcher<ReloadResult> *mReloadWatcher;
+    bool mReloadPending = false;
+    bool mProgressPending = false;
+    bool mLoadingState = false;
 
     QDateTime mMinDate;
     QDateTime mMaxDate;
@@ -0,0 +1,224 @@
+#include "commitgraph.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+const qint32 idSize = 20;
+const qint32 headerSize = 8;
+const qint32 chunkEntrySize = 12;
+const qint32 commitDataSize = idSize + 16;
+const quint32 parentNone = 0x70000000;
+const quint32 parentExtraEdges = 0x80000000;
+const quint32 lastEdge = 0x80000000;
+
+quint32 chunkId(const char *name)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(name));
+}
+}
+
+CommitGraph::CommitGraph()
+{
+
+}
+
+CommitGraph::~CommitGraph()
+{
+    close();
+}
+
+QString CommitGraph::fileName(const QString &repositoryPath)
+{
+    QDir dir(repositoryPath);
+    if (QFileInfo(dir.filePath(QStringLiteral(".git"))).isDir())
+        dir.cd(QStringLiteral(".git"));
+
+    // Git itself ignores the commit-graph of shallow and grafted repositories
+    if (QFileInfo::exists(dir.filePath(QStringLiteral("shallow"))) || QFileInfo::exists(dir.filePath(QStringLiteral("info/grafts"))))
+        return QString();
+
+    const auto res = dir.filePath(QStringLiteral("objects/info/commit-graph"));
+    return QFileInfo::exists(res)? res : QString();
+}
+
+bool CommitGraph::open(const QString &fileName)
+{
+    close();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QFile::ReadOnly))
+        return false;
+
+    mSize = mFile.size();
+    mData = (mSize >= headerSize? mFile.map(0, mSize) : nullptr);
+    if (!mData)
+    {
+        close();
+        return false;
+    }
+
+    // Header: signature, version, hash version, chunk count, base graph count
+    if (std::memcmp(mData, "CGPH", 4) != 0 || mData[4] != 1 || mData[5] != 1 || mData[7] != 0)
+    {
+        close();
+        return false;
+    }
+
+    const qint32 chunks = mData[6];
+    if (headerSize + (chunks + 1) * chunkEntrySize > mSize)
+    {
+        close();
+        return false;
+    }
+
+    qint64 idsSize = 0;
+    qint64 commitsSize = 0;
+    qint64 edgesSize = 0;
+    for (qint32 i=0; i<chunks; i++)
+    {
+        const auto entry = mData + headerSize + i * chunkEntrySize;
+        const auto id = qFromBigEndian<quint32>(entry);
+        const auto offset = qFromBigEndian<quint64>(entry + 4);
+        const auto next = qFromBigEndian<quint64>(entry + chunkEntrySize + 4);
+        if (offset > next || next > static_cast<quint64>(mSize))
+        {
+            close();
+            return false;
+        }
+
+        const auto size = static_cast<qint64>(next - offset);
+        if (id == chunkId("OIDF") && size == 256 * 4)
+            mFanout = mData + offset;
+        else if (id == chunkId("OIDL"))
+        {
+            mIds = mData + offset;
+            idsSize = size;
+        }
+        else if (id == chunkId("CDAT"))
+        {
+            mCommits = mData + offset;
+            commitsSize = size;
+        }
+        else if (id == chunkId("EDGE"))
+        {
+            mEdges = mData + offset;
+            edgesSize = size;
+        }
+    }
+
+    if (!mFanout || !mIds || !mCommits)
+    {
+        close();
+        return false;
+    }
+
+    mCount = qFromBigEndian<quint32>(mFanout + 255 * 4);
+    mEdgesCount = static_cast<quint32>(edgesSize / 4);
+    if (idsSize != static_cast<qint64>(mCount) * idSize || commitsSize != static_cast<qint64>(mCount) * commitDataSize)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void CommitGraph::close()
+{
+    if (mData)
+        mFile.unmap(const_cast<uchar*>(mData));
+    mFile.close();
+
+    mData = nullptr;
+    mSize = 0;
+    mCount = 0;
+    mFanout = nullptr;
+    mIds = nullptr;
+    mCommits = nullptr;
+    mEdges = nullptr;
+    mEdgesCount = 0;
+}
+
+bool CommitGraph::isOpen() const
+{
+    return mData != nullptr;
+}
+
+quint32 CommitGraph::count() const
+{
+    return mCount;
+}
+
+quint32 CommitGraph::find(const QByteArray &rawId) const
+{
+    if (!mData || rawId.size() != idSize)
+        return noPosition;
+
+    // The fanout table narrows the binary search to ids sharing the first byte
+    const auto first = static_cast<uchar>(rawId.at(0));
+    quint32 lo = (first? qFromBigEndian<quint32>(mFanout + (first - 1) * 4) : 0);
+    quint32 hi = qFromBigEndian<quint32>(mFanout + first * 4);
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+        const auto cmp = std::memcmp(mIds + static_cast<qint64>(mid) * idSize, rawId.constData(), idSize);
+        if (cmp == 0)
+            return mid;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return noPosition;
+}
+
+QByteArray CommitGraph::rawId(quint32 position) const
+{
+    return QByteArray(reinterpret_cast<const char*>(mIds + static_cast<qint64>(position) * idSize), idSize);
+}
+
+qint64 CommitGraph::time(quint32 position) const
+{
+    // The last 8 bytes hold the generation number and a 34-bit commit date
+    const auto data = mCommits + static_cast<qint64>(position) * commitDataSize + idSize + 8;
+    const auto high = qFromBigEndian<quint32>(data) & 0x3;
+    const auto low = qFromBigEndian<quint32>(data + 4);
+    return (static_cast<qint64>(high) << 32) | low;
+}
+
+void CommitGraph::parents(quint32 position, QVector<quint32> &res) const
+{
+    res.clear();
+
+    const auto data = mCommits + static_cast<qint64>(position) * commitDataSize + idSize;
+    const auto first = qFromBigEndian<quint32>(data);
+    const auto second = qFromBigEndian<quint32>(data + 4);
+
+    if (first != parentNone && first < mCount)
+        res << first;
+    if (second == parentNone)
+        return;
+
+    if (!(second & parentExtraEdges))
+    {
+        if (second < mCount)
+            res << second;
+        return;
+    }
+
+    // Octopus merges list their other parents in the extra edges chunk
+    for (auto e = second & ~parentExtraEdges; e < mEdgesCount; e++)
+    {
+        const auto value = qFromBigEndian<quint32>(mEdges + static_cast<qint64>(e) * 4);
+        const auto parent = value & ~lastEdge;
+        if (parent < mCount)
+            res << parent;
+        if (value & lastEdge)
+            break;
+    }
+}
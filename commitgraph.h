@@ -0,0 +1,50 @@
+#ifndef COMMITGRAPH_H
+#define COMMITGRAPH_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/*!
+ * Read-only view of a repository's ".git/objects/info/commit-graph" file.
+ * The file is memory-mapped and commit ids, commit dates and parents are
+ * read straight from its OIDF/OIDL/CDAT/EDGE chunks, without starting any
+ * git process. Only single-file SHA-1 graphs are supported; callers fall
+ * back to "git log" whenever open() fails or a commit isn't in the graph.
+ */
+class CommitGraph
+{
+public:
+    static const quint32 noPosition = 0xffffffff;
+
+    CommitGraph();
+    virtual ~CommitGraph();
+
+    static QString fileName(const QString &repositoryPath);
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+
+    quint32 count() const;
+    quint32 find(const QByteArray &rawId) const;
+
+    QByteArray rawId(quint32 position) const;
+    qint64 time(quint32 position) const;
+    void parents(quint32 position, QVector<quint32> &res) const;
+
+private:
+    QFile mFile;
+    const uchar *mData = nullptr;
+    qint64 mSize = 0;
+
+    quint32 mCount = 0;
+    const uchar *mFanout = nullptr;
+    const uchar *mIds = nullptr;
+    const uchar *mCommits = nullptr;
+    const uchar *mEdges = nullptr;
+    quint32 mEdgesCount = 0;
+};
+
+#endif // COMMITGRAPH_H
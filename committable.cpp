@@ -0,0 +1,179 @@
+#include "committable.h"
+
+CommitTable::CommitTable()
+{
+    mCommentOffsets << 0;
+}
+
+CommitTable::~CommitTable()
+{
+
+}
+
+bool CommitTable::append(const GitCommands::CommitStat &c)
+{
+    const auto id = QByteArray::fromHex(c.commit.id.toLatin1());
+    if (id.size() != mIdSize || mRows.contains(id))
+        return false;
+
+    mRows[id] = mTimes.count();
+    mIds += id;
+
+    mTimes << c.commit.datetime.toSecsSinceEpoch();
+    mInsertions << c.insertions;
+    mDeletions << c.deletions;
+    mTotalFiles << c.totalFiles;
+    mApproximate << c.approximate;
+
+    auto author = mAuthorIndexes.value(c.commit.commiter, -1);
+    if (author < 0)
+    {
+        author = mAuthorNames.count();
+        mAuthorNames << c.commit.commiter;
+        mAuthorIndexes[c.commit.commiter] = author;
+    }
+    mAuthors << author;
+
+    mComments += c.commit.comment.toUtf8();
+    mCommentOffsets << mComments.size();
+    return true;
+}
+
+void CommitTable::reserve(qint32 size)
+{
+    mIds.reserve(size * mIdSize);
+    mRows.reserve(size);
+    mTimes.reserve(size);
+    mInsertions.reserve(size);
+    mDeletions.reserve(size);
+    mTotalFiles.reserve(size);
+    mApproximate.reserve(size);
+    mAuthors.reserve(size);
+    mCommentOffsets.reserve(size + 1);
+}
+
+void CommitTable::clear()
+{
+    const auto idSize = mIdSize;
+    *this = CommitTable();
+    mIdSize = idSize;
+}
+
+qint32 CommitTable::idSize() const
+{
+    return mIdSize;
+}
+
+void CommitTable::setIdSize(qint32 newIdSize)
+{
+    // Rows of different hash algorithms can't share a table
+    if (mIdSize != newIdSize)
+        clear();
+    mIdSize = newIdSize;
+}
+
+qint32 CommitTable::count() const
+{
+    return mTimes.count();
+}
+
+bool CommitTable::isEmpty() const
+{
+    return mTimes.isEmpty();
+}
+
+bool CommitTable::contains(const QByteArray &rawId) const
+{
+    return mRows.contains(rawId);
+}
+
+QByteArray CommitTable::rawId(qint32 row) const
+{
+    return mIds.mid(row * mIdSize, mIdSize);
+}
+
+QString CommitTable::id(qint32 row) const
+{
+    return QString::fromLatin1(rawId(row).toHex());
+}
+
+qint64 CommitTable::time(qint32 row) const
+{
+    return mTimes.at(row);
+}
+
+QDateTime CommitTable::datetime(qint32 row) const
+{
+    return QDateTime::fromSecsSinceEpoch(mTimes.at(row));
+}
+
+qint32 CommitTable::insertions(qint32 row) const
+{
+    return mInsertions.at(row);
+}
+
+qint32 CommitTable::deletions(qint32 row) const
+{
+    return mDeletions.at(row);
+}
+
+qint32 CommitTable::totalFiles(qint32 row) const
+{
+    return mTotalFiles.at(row);
+}
+
+bool CommitTable::approximate(qint32 row) const
+{
+    return mApproximate.at(row);
+}
+
+qint32 CommitTable::author(qint32 row) const
+{
+    return mAuthors.at(row);
+}
+
+QString CommitTable::comment(qint32 row) const
+{
+    const auto from = mCommentOffsets.at(row);
+    return QString::fromUtf8(mComments.constData() + from, mCommentOffsets.at(row + 1) - from);
+}
+
+const QVector<qint64> &CommitTable::times() const
+{
+    return mTimes;
+}
+
+const QVector<qint32> &CommitTable::insertions() const
+{
+    return mInsertions;
+}
+
+const QVector<qint32> &CommitTable::deletions() const
+{
+    return mDeletions;
+}
+
+const QVector<qint32> &CommitTable::totalFiles() const
+{
+    return mTotalFiles;
+}
+
+const QVector<bool> &CommitTable::approximate() const
+{
+    return mApproximate;
+}
+
+const QVector<qint32> &CommitTable::authors() const
+{
+    return mAuthors;
+}
+
+qint32 CommitTable::authorsCount() const
+{
+    return mAuthorNames.count();
+}
+
+QString CommitTable::authorName(qint32 author) const
+{
+    return mAuthorNames.at(author);
+}
@@ -0,0 +1,77 @@
+#ifndef COMMITTABLE_H
+#define COMMITTABLE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include "gitcommands.h"
+
+/*!
+ * Structure-of-arrays store of the analized commits of one repository.
+ * Object ids are kept as binary hashes of idSize() bytes (20 for SHA-1
+ * repositories, 32 for SHA-256 ones), dates as epoch seconds
+ * and authors are interned, so scans over a single column stay compact
+ * and cache friendly. Rows whose diff ran out of time only have their
+ * files counted and are flagged approximate. All columns are implicitly
+ * shared.
+ */
+class CommitTable
+{
+public:
+    CommitTable();
+    virtual ~CommitTable();
+
+    bool append(const GitCommands::CommitStat &commit);
+    void reserve(qint32 size);
+    void clear();
+
+    qint32 idSize() const;
+    void setIdSize(qint32 newIdSize);
+
+    qint32 count() const;
+    bool isEmpty() const;
+    bool contains(const QByteArray &rawId) const;
+
+    QByteArray rawId(qint32 row) const;
+    QString id(qint32 row) const;
+    qint64 time(qint32 row) const;
+    QDateTime datetime(qint32 row) const;
+    qint32 insertions(qint32 row) const;
+    qint32 deletions(qint32 row) const;
+    qint32 totalFiles(qint32 row) const;
+    bool approximate(qint32 row) const;
+    qint32 author(qint32 row) const;
+    QString comment(qint32 row) const;
+
+    const QVector<qint64> &times() const;
+    const QVector<qint32> &insertions() const;
+    const QVector<qint32> &deletions() const;
+    const QVector<qint32> &totalFiles() const;
+    const QVector<bool> &approximate() const;
+    const QVector<qint32> &authors() const;
+
+    qint32 authorsCount() const;
+    QString authorName(qint32 author) const;
+
+private:
+    qint32 mIdSize = 20;
+    QByteArray mIds;
+    QHash<QByteArray, qint32> mRows;
+    QVector<qint64> mTimes;
+    QVector<qint32> mInsertions;
+    QVector<qint32> mDeletions;
+    QVector<qint32> mTotalFiles;
+    QVector<bool> mApproximate;
+    QVector<qint32> mAuthors;
+
+    QByteArray mComments;
+    QVector<qint32> mCommentOffsets;
+
+    QStringList mAuthorNames;
+    QHash<QString, qint32> mAuthorIndexes;
+};
+
+#endif // COMMITTABLE_H
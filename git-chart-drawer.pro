@@ -1,4 +1,4 @@
-QT += widgets charts
+QT += widgets charts concurrent
 CONFIG += c++17
 VERSION = 0.1.0
 
@@ -8,15 +8,33 @@ include(fonts/fonts.pri)
 SOURCES += \
     abstractchartwidget.cpp \
     commitchartwidget.cpp \
+    commitgraph.cpp \
+    committable.cpp \
     gitcommands.cpp \
+    gitlogparser.cpp \
+    gitscheduler.cpp \
+    ingestionqueue.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    repositorysession.cpp \
+    seriesrollup.cpp \
+    statscache.cpp \
+    timebuckets.cpp
 
 HEADERS += \
     abstractchartwidget.h \
     commitchartwidget.h \
+    commitgraph.h \
+    committable.h \
     gitcommands.h \
-    mainwindow.h
+    gitlogparser.h \
+    gitscheduler.h \
+    ingestionqueue.h \
+    mainwindow.h \
+    repositorysession.h \
+    seriesrollup.h \
+    statscache.h \
+    timebuckets.h
 
 FORMS += \
     mainwindow.ui
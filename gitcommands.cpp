@@ -1,9 +1,321 @@
 #include "gitcommands.h"
+#include "commitgraph.h"
+#include "gitlogparser.h"
+#include "gitscheduler.h"
 
+#include <QFutureWatcher>
 #include <QProcess>
-#include <QRegExp>
+#include <QQueue>
+#include <QTimer>
+#include <QtConcurrent>
 #include <QDebug>
 
+#include <limits>
+#include <memory>
+
+/*!
+ * "git diff-tree --stdin" process of one repository. Every queried commit
+ * is written to stdin followed by an end marker line, which diff-tree
+ * echoes back after the commit's numstat lines. Answers of one process
+ * come back in request order, so a FIFO of callbacks is enough to hand
+ * each block of stats to its caller. Callbacks get the commit id with
+ * its stats, since a timed out commit is answered later than the ones
+ * queued after it, and whether they are real: commits still pending when
+ * the process dies are answered as failed.
+ *
+ * The process is started through the GitScheduler like any other job and
+ * its stdin is closed once every query written to it is answered. While
+ * other repositories have jobs waiting, new queries are held back instead
+ * of being written, so the process drains, exits and gives its slot back,
+ * and the held queries go to a new process queued behind those jobs.
+ *
+ * With a timeout, a commit not answered in time is handed to the fallback
+ * and the process is replaced by a new one for the commits after it.
+ */
+class StatCoprocess: public QObject
+{
+public:
+    typedef std::function<void(QString, QList<GitCommands::Stat>, bool)> Callback;
+    typedef std::function<void(QString, Callback)> Fallback;
+
+    StatCoprocess(const QString &path, const QStringList &arguments, QObject *parent = Q_NULLPTR)
+        : QObject(parent),
+          mPath(path),
+          mArguments(arguments)
+    {
+        mTimer = new QTimer(this);
+        mTimer->setSingleShot(true);
+        connect(mTimer, &QTimer::timeout, this, &StatCoprocess::stall);
+    }
+
+    virtual ~StatCoprocess()
+    {
+        if (!mProcess)
+            return;
+
+        GitScheduler::instance()->cancel(mProcess);
+        mProcess->disconnect(this);
+        mProcess->kill();
+    }
+
+    void setTimeout(qint32 timeout, Fallback fallback)
+    {
+        mTimeout = timeout;
+        mFallback = fallback;
+    }
+
+    void query(const QStringList &commits, Callback callback)
+    {
+        QByteArray batch;
+        for (const auto &c: commits)
+        {
+            batch += request(c);
+            mCommits.enqueue(c);
+            mCallbacks.enqueue(callback);
+        }
+
+        if (!mProcess)
+            start();
+
+        // Queries made before the scheduler started the process wait for
+        // it, and so do queries held back for other repositories. Held
+        // queries are never overtaken, answers must keep request order.
+        if (mProcess->state() == QProcess::Running && mInput.isEmpty() && !GitScheduler::instance()->isContended(mPath))
+        {
+            mProcess->write(batch);
+            mWritten += commits.count();
+        }
+        else
+        {
+            mInput += batch;
+        }
+    }
+
+    qint32 pending() const
+    {
+        return mCallbacks.count();
+    }
+
+protected:
+    static QByteArray endMarker()
+    {
+        return QByteArrayLiteral(":end");
+    }
+
+    static QByteArray request(const QString &commit)
+    {
+        return commit.toUtf8() + '\n' + endMarker() + '\n';
+    }
+
+    void start()
+    {
+        mProcess = new QProcess(this);
+        mProcess->setWorkingDirectory(mPath);
+        mProcess->setArguments(mArguments);
+        mProcess->setProgram(QStringLiteral("git"));
+
+        connect(mProcess, &QProcess::started, this, [this](){
+            mProcess->write(mInput);
+            mInput.clear();
+            mWritten = mCallbacks.count();
+            restartTimer();
+        });
+        connect(mProcess, &QProcess::readyReadStandardOutput, this, &StatCoprocess::readOutput);
+        connect(mProcess, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this](int, QProcess::ExitStatus){
+            abort();
+        });
+        connect(mProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error){
+            if (error == QProcess::FailedToStart)
+                abort();
+        });
+
+        GitScheduler::instance()->start(mPath, mProcess);
+    }
+
+    void restartTimer()
+    {
+        // Every answer gives the next commit a full timeout
+        if (mTimeout > 0 && mWritten > 0)
+            mTimer->start(mTimeout);
+        else
+            mTimer->stop();
+    }
+
+    void retire()
+    {
+        // The process exits once its stdin is closed, which frees its slot
+        auto p = mProcess;
+        mProcess = Q_NULLPTR;
+        mBuffer.clear();
+        mWritten = 0;
+        mTimer->stop();
+
+        p->disconnect(this);
+        connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), p, &QObject::deleteLater);
+        p->closeWriteChannel();
+    }
+
+    void readOutput()
+    {
+        mBuffer += mProcess->readAllStandardOutput();
+
+        int from = 0;
+        int idx;
+        while ((idx = mBuffer.indexOf('\n', from)) != -1)
+        {
+            const auto line = QByteArray::fromRawData(mBuffer.constData() + from, idx - from);
+            from = idx + 1;
+
+            if (line == endMarker())
+            {
+                if (mCallbacks.isEmpty())
+                    continue;
+
+                auto stats = mCurrent;
+                mCurrent.clear();
+                const auto commit = mCommits.dequeue();
+                mWritten--;
+                mCallbacks.dequeue()(commit, stats, true);
+                restartTimer();
+                continue;
+            }
+
+            GitCommands::Stat s;
+            if (GitLogParser::parseStat(line.constData(), line.constData() + line.size(), s))
+                mCurrent << s;
+        }
+
+        mBuffer.remove(0, from);
+        if (mProcess && mWritten <= 0)
+        {
+            retire();
+            if (mCallbacks.count())
+                start();
+        }
+    }
+
+    void stall()
+    {
+        if (!mProcess || mCallbacks.isEmpty())
+            return;
+
+        const auto commit = mCommits.dequeue();
+        const auto callback = mCallbacks.dequeue();
+
+        auto p = mProcess;
+        mProcess = Q_NULLPTR;
+        mBuffer.clear();
+        mInput.clear();
+        mCurrent.clear();
+        mWritten = 0;
+
+        GitScheduler::instance()->cancel(p);
+        p->disconnect(this);
+        p->kill();
+        p->deleteLater();
+
+        // The commits queued after the slow one are asked again
+        if (mCommits.count())
+        {
+            for (const auto &c: mCommits)
+                mInput += request(c);
+            start();
+        }
+
+        mFallback(commit, callback);
+    }
+
+    void abort()
+    {
+        // Callbacks may query again, which starts a new process
+        mProcess->deleteLater();
+        mProcess = Q_NULLPTR;
+        mBuffer.clear();
+        mInput.clear();
+        mCurrent.clear();
+        mWritten = 0;
+        mTimer->stop();
+
+        auto commits = mCommits;
+        auto callbacks = mCallbacks;
+        mCommits.clear();
+        mCallbacks.clear();
+        while (!callbacks.isEmpty())
+            callbacks.dequeue()(commits.dequeue(), {}, false);
+    }
+
+private:
+    QString mPath;
+    QStringList mArguments;
+    QProcess *mProcess = Q_NULLPTR;
+    QByteArray mInput;
+    qint32 mWritten = 0;
+    QByteArray mBuffer;
+    QList<GitCommands::Stat> mCurrent;
+    QQueue<QString> mCommits;
+    QQueue<Callback> mCallbacks;
+
+    QTimer *mTimer;
+    qint32 mTimeout = 0;
+    Fallback mFallback;
+};
+
+namespace {
+struct GraphWalk {
+    bool found = false;
+    QList<GitCommands::Commit> commits;
+};
+
+// Commits reachable from head, straight from the commit-graph file
+GraphWalk walkGraph(const QString &fileName, const QByteArray &head, const GitCommands::LogOptions &options)
+{
+    GraphWalk res;
+    CommitGraph graph;
+    if (!graph.open(fileName))
+        return res;
+
+    const auto start = graph.find(head);
+    if (start == CommitGraph::noPosition)
+        return res;
+
+    const auto since = (options.since.isValid()? options.since.toSecsSinceEpoch() : std::numeric_limits<qint64>::min());
+    const auto until = (options.until.isValid()? options.until.toSecsSinceEpoch() : std::numeric_limits<qint64>::max());
+
+    QVector<bool> seen(graph.count());
+    QVector<quint32> stack;
+    QVector<quint32> parents;
+    stack << start;
+    seen[start] = true;
+    while (!stack.isEmpty())
+    {
+        const auto pos = stack.takeLast();
+        graph.parents(pos, parents);
+
+        const auto time = graph.time(pos);
+        if (time >= since && time <= until && !(options.noMerges && parents.count() > 1))
+        {
+            GitCommands::Commit c;
+            c.id = QString::fromLatin1(graph.rawId(pos).toHex());
+            c.datetime = QDateTime::fromSecsSinceEpoch(time);
+            res.commits << c;
+        }
+
+        if (options.firstParent && parents.count() > 1)
+            parents.resize(1);
+
+        for (const auto p: parents)
+            if (!seen.at(p))
+            {
+                seen[p] = true;
+                stack << p;
+            }
+    }
+
+    res.found = true;
+    return res;
+}
+}
+
 GitCommands::GitCommands(QObject *parent)
     : QObject(parent)
 {
@@ -18,91 +330,453 @@ GitCommands::GitCommands(const QString &path, QObject *parent)
 
 GitCommands::~GitCommands()
 {
+    closeCoprocesses();
+}
+
+void GitCommands::listCommits(const LogOptions &options, std::function<void (QList<Commit>)> callback, std::function<void (bool)> finished)
+{
+    streamLog(QStringList() << QStringLiteral("log") << QStringLiteral("--format=") + GitLogParser::format() << logArguments(options), [callback](const QList<CommitStat> &stats){
+        QList<Commit> list;
+        for (const auto &c: stats)
+            list << c.commit;
+        callback(list);
+    }, finished);
+}
+
+void GitCommands::listGraphCommits(const LogOptions &options, std::function<void (QList<Commit>)> callback, std::function<void (bool)> finished)
+{
+    // Pathspecs and revision ranges need git log, and so does a head
+    // committed after the commit-graph file was last written.
+    const auto fileName = CommitGraph::fileName(mPath);
+    const auto head = QByteArray::fromHex(options.revisions.toLatin1());
+    if (mPathspecs.length() || head.toHex() != options.revisions.toLatin1() || fileName.isEmpty())
+    {
+        listCommits(options, callback, finished);
+        return;
+    }
+
+    // The walk reads the whole graph, so it runs off the caller's thread
+    auto watcher = new QFutureWatcher<GraphWalk>(this);
+    registerWatcher(watcher);
+
+    connect(watcher, &QFutureWatcher<GraphWalk>::finished, this, [this, watcher, options, callback, finished](){
+        const auto res = watcher->result();
+        watcher->deleteLater();
+        if (!res.found)
+        {
+            listCommits(options, callback, finished);
+            return;
+        }
+
+        callback(res.commits);
+        finished(true);
+    });
 
+    watcher->setFuture(QtConcurrent::run(walkGraph, fileName, head, options));
 }
 
-void GitCommands::listCommits(std::function<void (QList<Commit>)> callback)
+void GitCommands::commitDiff(const QString &commit, std::function<void (QString)> callback)
 {
     auto p = new QProcess(this);
     p->setWorkingDirectory(mPath);
-    p->setArguments({QStringLiteral("log"), QStringLiteral("--date=format:%Y-%m-%d %H:%M:%S")});
+    registerProcess(p);
+    p->setArguments(QStringList() << QStringLiteral("diff") << (commit + QStringLiteral("^!")) << pathspecArguments());
     p->setProgram(QStringLiteral("git"));
 
     connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int, QProcess::ExitStatus){
-        const auto data = QString::fromUtf8(p->readAll());
+        callback( QString::fromUtf8(p->readAll()) );
+        p->deleteLater();
+    });
 
-        QRegExp rx("commit\\s+(.+)\\s+Author\\:\\s+(.+)\\s+Date\\:\\s+(.+)\\n\\n\\s+(.+)\\n\\n");
-        rx.setMinimal(true);
+    GitScheduler::instance()->start(mPath, p);
+}
 
-        int pos = 0;
-        QList<Commit> list;
+void GitCommands::commitStat(const QString &commit, std::function<void (QList<Stat>, bool)> callback)
+{
+    auto p = new QProcess(this);
+    p->setWorkingDirectory(mPath);
+    registerProcess(p);
+    // Diffed like the coprocess does: a root commit against the empty tree,
+    // never against the working tree, and a merge against its first parent.
+    p->setArguments(QStringList() << configArguments() << QStringLiteral("diff-tree") << QStringLiteral("--no-commit-id") << QStringLiteral("--numstat")
+                                  << QStringLiteral("-r") << QStringLiteral("--root") << QStringLiteral("--diff-merges=first-parent")
+                                  << diffArguments() << commit << pathspecArguments());
+    p->setProgram(QStringLiteral("git"));
+
+    const auto done = connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int exitCode, QProcess::ExitStatus exitStatus){
+        const auto ok = (exitStatus == QProcess::NormalExit && exitCode == 0);
+        const auto list = (ok? GitLogParser::parseStats(p->readAllStandardOutput()) : QList<Stat>());
+        p->deleteLater();
+        callback(list, ok);
+    });
+
+    // A commit over its time budget only gets its changed files counted,
+    // and the stats are flagged as approximate.
+    if (mDiffOptions.timeout > 0)
+    {
+        const auto timeout = mDiffOptions.timeout;
+        connect(p, &QProcess::started, this, [this, p, done, timeout, commit, callback](){
+            QTimer::singleShot(timeout, p, [this, p, done, commit, callback](){
+                if (p->state() == QProcess::NotRunning)
+                    return;
 
-        while ((pos = rx.indexIn(data, pos)) != -1)
+                disconnect(done);
+                p->kill();
+                p->deleteLater();
+                approximateStat(commit, callback);
+            });
+        });
+    }
+
+    GitScheduler::instance()->start(mPath, p);
+}
+
+void GitCommands::commitFiles(const QString &commit, std::function<void (QList<Stat>, bool)> callback)
+{
+    auto p = new QProcess(this);
+    p->setWorkingDirectory(mPath);
+    registerProcess(p);
+    p->setArguments(QStringList() << configArguments() << QStringLiteral("diff-tree") << QStringLiteral("--no-commit-id") << QStringLiteral("--name-status")
+                                  << QStringLiteral("-r") << QStringLiteral("--root") << QStringLiteral("--diff-merges=first-parent")
+                                  << diffArguments() << commit << pathspecArguments());
+    p->setProgram(QStringLiteral("git"));
+
+    // Same rename detection as listCommitFiles, so a rename is one file.
+    // Its status line ends with the new name.
+    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int exitCode, QProcess::ExitStatus exitStatus){
+        const auto ok = (exitStatus == QProcess::NormalExit && exitCode == 0);
+        QList<Stat> list;
+        for (const auto &line: p->readAllStandardOutput().split('\n'))
         {
-            Commit c;
-            c.id = rx.cap(1).remove(QRegExp("Merge\\:.+")).trimmed();
-            c.commiter = rx.cap(2).trimmed();
-            c.datetime = QDateTime::fromString(rx.cap(3).trimmed(), QStringLiteral("yyyy-MM-dd hh:mm:ss"));
-            c.comment = rx.cap(4).trimmed();
-
-            list << c;
-            pos += rx.matchedLength();
+            if (!ok || line.isEmpty())
+                continue;
+
+            Stat s;
+            s.fileName = QString::fromUtf8(line.mid(line.lastIndexOf('\t') + 1));
+            list << s;
         }
 
         p->deleteLater();
-        callback(list);
+        callback(list, ok);
     });
 
-    p->start();
+    GitScheduler::instance()->start(mPath, p);
 }
 
-void GitCommands::commitDiff(const QString &commit, std::function<void (QString)> callback)
+void GitCommands::approximateStat(const QString &commit, std::function<void (QList<Stat>, bool)> callback)
+{
+    // Used when diffing a commit takes over the time budget
+    commitFiles(commit, [callback](QList<Stat> list, bool ok){
+        for (auto &s: list)
+            s.approximate = true;
+        callback(list, ok);
+    });
+}
+
+void GitCommands::listCommitStats(const LogOptions &options, std::function<void (QList<CommitStat>)> callback, std::function<void (bool)> finished,
+                                  std::function<void ()> stalled)
+{
+    streamLog(QStringList() << configArguments() << QStringLiteral("log") << QStringLiteral("--numstat") << QStringLiteral("--diff-merges=first-parent")
+                            << diffArguments() << QStringLiteral("--format=") + GitLogParser::format() << logArguments(options), callback, finished,
+              QByteArray(), stalled);
+}
+
+void GitCommands::listCommitStats(const QStringList &commits, std::function<void (QList<CommitStat>)> callback, std::function<void (bool)> finished,
+                                  std::function<void ()> stalled)
+{
+    // Exactly the given commits, read from stdin, in the given order
+    QByteArray input;
+    for (const auto &c: commits)
+        input += c.toLatin1() + '\n';
+
+    streamLog(QStringList() << configArguments() << QStringLiteral("log") << QStringLiteral("--numstat") << QStringLiteral("--diff-merges=first-parent")
+                            << diffArguments() << QStringLiteral("--format=") + GitLogParser::format() << QStringLiteral("--no-walk=unsorted")
+                            << QStringLiteral("--stdin") << pathspecArguments(), callback, finished, input, stalled);
+}
+
+void GitCommands::listCommitFiles(const LogOptions &options, std::function<void (QList<CommitStat>)> callback, std::function<void (bool)> finished)
+{
+    // No line is diffed. Renames are detected exactly as for the numstat
+    // log, so both count a renamed file once; with --no-renames only
+    // trees are compared.
+    streamLog(QStringList() << configArguments() << QStringLiteral("log") << QStringLiteral("--name-status") << QStringLiteral("--diff-merges=first-parent")
+                            << diffArguments() << QStringLiteral("--format=") + GitLogParser::format() << logArguments(options), callback, finished);
+}
+
+void GitCommands::listCommitIds(const LogOptions &options, std::function<void (QStringList)> callback)
 {
     auto p = new QProcess(this);
     p->setWorkingDirectory(mPath);
-    p->setArguments({QStringLiteral("diff"), (commit + QStringLiteral("^!"))});
+    registerProcess(p);
+    p->setArguments(QStringList() << QStringLiteral("rev-list") << logArguments(options));
     p->setProgram(QStringLiteral("git"));
 
     connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int, QProcess::ExitStatus){
-        callback( QString::fromUtf8(p->readAll()) );
+        // Only full SHA-1 or SHA-256 object ids are taken
+        QStringList list;
+        for (const auto &line: p->readAllStandardOutput().split('\n'))
+        {
+            if (line.size() != 40 && line.size() != 64)
+                continue;
+            if (QByteArray::fromHex(line).toHex() != line)
+                continue;
+
+            list << QString::fromLatin1(line);
+        }
+
         p->deleteLater();
+        callback(list);
     });
 
-    p->start();
+    GitScheduler::instance()->start(mPath, p);
 }
 
-void GitCommands::commitStat(const QString &commit, std::function<void (QList<Stat>)> callback)
+void GitCommands::revParse(const QString &ref, std::function<void (QString)> callback)
 {
     auto p = new QProcess(this);
     p->setWorkingDirectory(mPath);
-    p->setArguments({QStringLiteral("diff"), (commit + QStringLiteral("^!")), QStringLiteral("--numstat")});
+    registerProcess(p);
+    p->setArguments({QStringLiteral("rev-parse"), QStringLiteral("--verify"), QStringLiteral("--quiet"), ref});
     p->setProgram(QStringLiteral("git"));
 
-    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int, QProcess::ExitStatus){
-        const auto data = QString::fromUtf8(p->readAll());
+    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int exitCode, QProcess::ExitStatus){
+        const auto res = (exitCode == 0? QString::fromLatin1(p->readAllStandardOutput()).trimmed() : QString());
+        p->deleteLater();
+        callback(res);
+    });
 
-        QRegExp rx("(\\d+)\\s+(\\d+)\\s+(.+)\\n");
-        rx.setMinimal(true);
+    GitScheduler::instance()->start(mPath, p);
+}
 
-        int pos = 0;
-        QList<Stat> list;
+void GitCommands::isAncestor(const QString &ancestor, const QString &commit, std::function<void (bool)> callback)
+{
+    auto p = new QProcess(this);
+    p->setWorkingDirectory(mPath);
+    registerProcess(p);
+    p->setArguments({QStringLiteral("merge-base"), QStringLiteral("--is-ancestor"), ancestor, commit});
+    p->setProgram(QStringLiteral("git"));
 
-        while ((pos = rx.indexIn(data, pos)) != -1)
-        {
-            Stat c;
-            c.insertions = rx.cap(1).trimmed().toInt();
-            c.deletions = rx.cap(2).trimmed().toInt();
-            c.fileName = rx.cap(3).trimmed();
+    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, callback](int exitCode, QProcess::ExitStatus exitStatus){
+        p->deleteLater();
+        callback(exitStatus == QProcess::NormalExit && exitCode == 0);
+    });
 
-            list << c;
-            pos += rx.matchedLength();
-        }
+    GitScheduler::instance()->start(mPath, p);
+}
+
+QStringList GitCommands::logArguments(const LogOptions &options) const
+{
+    QStringList args;
+    if (options.since.isValid())
+        args << QStringLiteral("--since=@%1").arg(options.since.toSecsSinceEpoch());
+    if (options.until.isValid())
+        args << QStringLiteral("--until=@%1").arg(options.until.toSecsSinceEpoch());
+    if (options.firstParent)
+        args << QStringLiteral("--first-parent");
+    if (options.noMerges)
+        args << QStringLiteral("--no-merges");
+    if (options.revisions.length())
+        args << options.revisions;
+
+    // Without it, history simplification skips side branches that leave
+    // the filtered paths as they found them, even if they touched them.
+    if (mPathspecs.length())
+        args << QStringLiteral("--full-history");
+
+    args << pathspecArguments();
+    return args;
+}
+
+QStringList GitCommands::pathspecArguments() const
+{
+    if (mPathspecs.isEmpty())
+        return QStringList();
+
+    return QStringList() << QStringLiteral("--") << mPathspecs;
+}
+
+QStringList GitCommands::configArguments() const
+{
+    // Blobs over core.bigFileThreshold are treated as binary and never diffed
+    if (mDiffOptions.bigFileThreshold <= 0)
+        return QStringList();
+
+    return QStringList() << QStringLiteral("-c") << QStringLiteral("core.bigFileThreshold=%1").arg(mDiffOptions.bigFileThreshold);
+}
+
+QStringList GitCommands::diffArguments() const
+{
+    QStringList args;
+    if (!mDiffOptions.renames)
+        args << QStringLiteral("--no-renames");
+    if (!mDiffOptions.textConv)
+        args << QStringLiteral("--no-textconv");
+    return args;
+}
+
+void GitCommands::streamLog(const QStringList &arguments, std::function<void (QList<CommitStat>)> callback, std::function<void (bool)> finished,
+                            const QByteArray &input, std::function<void ()> stalled)
+{
+    const qint32 batchSize = 1024;
+
+    auto p = new QProcess(this);
+    p->setWorkingDirectory(mPath);
+    registerProcess(p);
+    p->setArguments(arguments);
+    p->setProgram(QStringLiteral("git"));
+
+    auto parser = std::make_shared<GitLogParser>();
+
+    if (input.length())
+        connect(p, &QProcess::started, this, [p, input](){
+            p->write(input);
+            p->closeWriteChannel();
+        });
+
+    // A log silent for longer than the timeout is stuck on one commit's
+    // diff. Commits parsed so far are handed out, the log is stopped and
+    // the caller decides how to go on. git flushes every commit it writes
+    // to a pipe, so a slow diff is the only silence.
+    QTimer *watchdog = Q_NULLPTR;
+    if (stalled && mDiffOptions.timeout > 0)
+    {
+        watchdog = new QTimer(p);
+        watchdog->setSingleShot(true);
+        watchdog->setInterval(mDiffOptions.timeout);
+
+        connect(p, &QProcess::started, watchdog, static_cast<void(QTimer::*)()>(&QTimer::start));
+        connect(watchdog, &QTimer::timeout, this, [this, p, parser, callback, stalled](){
+            // Disconnecting also drops the handler that unregisters it
+            GitScheduler::instance()->cancel(p);
+            p->disconnect(this);
+            mProcesses.remove(mPath, p);
+            p->kill();
+            p->deleteLater();
+
+            if (parser->count())
+                callback(parser->take());
+            stalled();
+        });
+    }
+
+    connect(p, &QProcess::readyReadStandardOutput, this, [p, parser, callback, watchdog](){
+        if (watchdog)
+            watchdog->start();
+
+        parser->feed(p->readAllStandardOutput());
+        if (parser->count() >= batchSize)
+            callback(parser->take());
+    });
+    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [p, parser, callback, finished, watchdog](int exitCode, QProcess::ExitStatus exitStatus){
+        if (watchdog)
+            watchdog->stop();
+
+        // A failed log may have stopped in the middle of a commit, so its
+        // last record is dropped. The caller is told the log is incomplete.
+        const auto ok = (exitStatus == QProcess::NormalExit && exitCode == 0);
+        parser->feed(p->readAllStandardOutput());
+        if (ok)
+            parser->finish();
+        if (parser->count())
+            callback(parser->take());
 
         p->deleteLater();
-        callback(list);
+        finished(ok);
+    });
+
+    GitScheduler::instance()->start(mPath, p);
+}
+
+void GitCommands::queryStat(const QString &commit, std::function<void (QList<Stat>, bool)> callback)
+{
+    coprocess()->query({commit}, [callback](const QString &, const QList<Stat> &stats, bool ok){
+        callback(stats, ok);
     });
+}
+
+void GitCommands::queryStats(const QStringList &commits, std::function<void (QString, QList<Stat>, bool)> callback)
+{
+    // Answers name their commit and may come in any order
+    if (commits.isEmpty())
+        return;
+
+    coprocess()->query(commits, callback);
+}
+
+void GitCommands::cancel(const QString &path)
+{
+    // Jobs leave the scheduler before they are killed, so a queued one
+    // can't be started in the meantime.
+    for (auto p: mProcesses.values(path))
+    {
+        GitScheduler::instance()->cancel(p);
+        p->disconnect(this);
+        p->kill();
+        p->deleteLater();
+    }
+    mProcesses.remove(path);
+
+    // Running walks finish on their own, their results are just dropped
+    for (auto w: mWatchers.values(path))
+    {
+        w->disconnect(this);
+        w->deleteLater();
+    }
+    mWatchers.remove(path);
+
+    qDeleteAll(mCoprocesses.take(path));
+}
+
+void GitCommands::registerProcess(QProcess *p)
+{
+    const auto path = mPath;
+    mProcesses.insert(path, p);
+    connect(p, &QObject::destroyed, this, [this, path, p](){
+        mProcesses.remove(path, p);
+    });
+}
+
+void GitCommands::registerWatcher(QFutureWatcherBase *w)
+{
+    const auto path = mPath;
+    mWatchers.insert(path, w);
+    connect(w, &QObject::destroyed, this, [this, path, w](){
+        mWatchers.remove(path, w);
+    });
+}
 
-    p->start();
+void GitCommands::closeCoprocesses()
+{
+    for (const auto &list: mCoprocesses)
+        qDeleteAll(list);
+    mCoprocesses.clear();
+}
+
+StatCoprocess *GitCommands::coprocess()
+{
+    auto &list = mCoprocesses[mPath];
+    if (list.count() < mCoprocessCount)
+    {
+        const auto args = QStringList() << configArguments() << QStringLiteral("diff-tree") << QStringLiteral("--stdin") << QStringLiteral("--numstat") << QStringLiteral("-r")
+                                        << QStringLiteral("--root") << QStringLiteral("--diff-merges=first-parent") << diffArguments() << pathspecArguments();
+        auto c = new StatCoprocess(mPath, args, this);
+        if (mDiffOptions.timeout > 0)
+            c->setTimeout(mDiffOptions.timeout, [this](const QString &commit, StatCoprocess::Callback callback){
+                approximateStat(commit, [commit, callback](const QList<Stat> &stats, bool ok){
+                    callback(commit, stats, ok);
+                });
+            });
+
+        list << c;
+        return c;
+    }
+
+    StatCoprocess *res = list.first();
+    for (auto c: list)
+        if (c->pending() < res->pending())
+            res = c;
+
+    return res;
 }
 
 QString GitCommands::path() const
@@ -114,3 +788,45 @@ void GitCommands::setPath(const QString &newPath)
 {
     mPath = newPath;
 }
+
+qint32 GitCommands::coprocessCount() const
+{
+    return mCoprocessCount;
+}
+
+void GitCommands::setCoprocessCount(qint32 newCoprocessCount)
+{
+    mCoprocessCount = std::max(1, newCoprocessCount);
+}
+
+QStringList GitCommands::pathspecs() const
+{
+    return mPathspecs;
+}
+
+void GitCommands::setPathspecs(const QStringList &newPathspecs)
+{
+    if (mPathspecs == newPathspecs)
+        return;
+
+    // Running coprocesses were started with the previous pathspecs
+    mPathspecs = newPathspecs;
+    closeCoprocesses();
+}
+
+GitCommands::DiffOptions GitCommands::diffOptions() const
+{
+    return mDiffOptions;
+}
+
+void GitCommands::setDiffOptions(const DiffOptions &newDiffOptions)
+{
+    const auto restart = (mDiffOptions.renames != newDiffOptions.renames
+                          || mDiffOptions.textConv != newDiffOptions.textConv
+                          || mDiffOptions.bigFileThreshold != newDiffOptions.bigFileThreshold
+                          || mDiffOptions.timeout != newDiffOptions.timeout);
+
+    mDiffOptions = newDiffOptions;
+    if (restart)
+        closeCoprocesses();
+}
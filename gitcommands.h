@@ -2,9 +2,15 @@
 #define GITCOMMANDS_H
 
 #include <QDateTime>
+#include <QMultiHash>
 #include <QObject>
+#include <QVector>
 #include <functional>
 
+class StatCoprocess;
+class QFutureWatcherBase;
+class QProcess;
+
 class GitCommands : public QObject
 {
     Q_OBJECT
@@ -20,24 +26,90 @@ public:
         QString fileName;
         qint32 insertions = 0;
         qint32 deletions = 0;
+        bool approximate = false;
+    };
+
+    struct CommitStat {
+        Commit commit;
+        qint32 insertions = 0;
+        qint32 deletions = 0;
+        qint32 totalFiles = 0;
+        bool approximate = false;
+    };
+
+    struct LogOptions {
+        QString revisions;
+        QDateTime since;
+        QDateTime until;
+        bool firstParent = false;
+        bool noMerges = false;
+    };
+
+    struct DiffOptions {
+        bool renames = true;
+        bool textConv = true;
+        qint64 bigFileThreshold = 0;
+        qint32 timeout = 0;
     };
 
     GitCommands(QObject *parent = nullptr);
     GitCommands(const QString &path, QObject *parent = nullptr);
     virtual ~GitCommands();
 
-    void listCommits(std::function<void(QList<Commit>)> callback);
+    void listCommits(const LogOptions &options, std::function<void(QList<Commit>)> callback, std::function<void(bool)> finished);
+    void listGraphCommits(const LogOptions &options, std::function<void(QList<Commit>)> callback, std::function<void(bool)> finished);
     void commitDiff(const QString &commit, std::function<void(QString)> callback);
-    void commitStat(const QString &commit, std::function<void(QList<Stat>)> callback);
+    void commitStat(const QString &commit, std::function<void(QList<Stat>, bool)> callback);
+    void commitFiles(const QString &commit, std::function<void(QList<Stat>, bool)> callback);
+    void listCommitStats(const LogOptions &options, std::function<void(QList<CommitStat>)> callback, std::function<void(bool)> finished,
+                         std::function<void()> stalled = nullptr);
+    void listCommitStats(const QStringList &commits, std::function<void(QList<CommitStat>)> callback, std::function<void(bool)> finished,
+                         std::function<void()> stalled = nullptr);
+    void listCommitFiles(const LogOptions &options, std::function<void(QList<CommitStat>)> callback, std::function<void(bool)> finished);
+    void listCommitIds(const LogOptions &options, std::function<void(QStringList)> callback);
+    void revParse(const QString &ref, std::function<void(QString)> callback);
+    void isAncestor(const QString &ancestor, const QString &commit, std::function<void(bool)> callback);
+
+    void queryStat(const QString &commit, std::function<void(QList<Stat>, bool)> callback);
+    void queryStats(const QStringList &commits, std::function<void(QString, QList<Stat>, bool)> callback);
+    void closeCoprocesses();
+    void cancel(const QString &path);
 
     QString path() const;
     void setPath(const QString &newPath);
 
+    qint32 coprocessCount() const;
+    void setCoprocessCount(qint32 newCoprocessCount);
+
+    QStringList pathspecs() const;
+    void setPathspecs(const QStringList &newPathspecs);
+
+    DiffOptions diffOptions() const;
+    void setDiffOptions(const DiffOptions &newDiffOptions);
+
 Q_SIGNALS:
 
 
+private:
+    QStringList logArguments(const LogOptions &options) const;
+    QStringList pathspecArguments() const;
+    QStringList configArguments() const;
+    QStringList diffArguments() const;
+    void streamLog(const QStringList &arguments, std::function<void(QList<CommitStat>)> callback, std::function<void(bool)> finished,
+                   const QByteArray &input = QByteArray(), std::function<void()> stalled = nullptr);
+    void approximateStat(const QString &commit, std::function<void(QList<Stat>, bool)> callback);
+    StatCoprocess *coprocess();
+    void registerProcess(QProcess *p);
+    void registerWatcher(QFutureWatcherBase *w);
+
 private:
     QString mPath;
+    qint32 mCoprocessCount = 1;
+    QStringList mPathspecs;
+    DiffOptions mDiffOptions;
+    QHash<QString, QList<StatCoprocess*>> mCoprocesses;
+    QMultiHash<QString, QProcess*> mProcesses;
+    QMultiHash<QString, QFutureWatcherBase*> mWatchers;
 };
 
 #endif // GITCOMMANDS_H
@@ -0,0 +1,190 @@
+#include "gitlogparser.h"
+
+#include <cstring>
+
+namespace {
+const char recordSeparator = '\x1e';
+const char unitSeparator = '\x1f';
+
+const char *findChar(const char *begin, const char *end, char c)
+{
+    auto res = static_cast<const char*>(std::memchr(begin, c, end - begin));
+    return res? res : end;
+}
+
+bool parseNumber(const char *begin, const char *end, qint64 &res)
+{
+    if (begin == end)
+        return false;
+
+    res = 0;
+    for (auto c = begin; c < end; c++)
+    {
+        if (*c < '0' || *c > '9')
+            return false;
+        res = res * 10 + (*c - '0');
+    }
+    return true;
+}
+}
+
+GitLogParser::GitLogParser()
+{
+
+}
+
+GitLogParser::~GitLogParser()
+{
+
+}
+
+QString GitLogParser::format()
+{
+    return QStringLiteral("%x1e%H%x1f%ct%x1f%an <%ae>%x1f%s");
+}
+
+bool GitLogParser::parseStat(const char *begin, const char *end, GitCommands::Stat &stat, bool fileName)
+{
+    const auto insEnd = findChar(begin, end, '\t');
+    if (insEnd == end)
+        return false;
+
+    const auto delBegin = insEnd + 1;
+    const auto delEnd = findChar(delBegin, end, '\t');
+    if (delEnd == end)
+        return false;
+
+    // Binary files are reported as "-\t-" and only count as a changed file
+    qint64 value = 0;
+    if (parseNumber(begin, insEnd, value))
+        stat.insertions = value;
+    else if (insEnd - begin != 1 || *begin != '-')
+        return false;
+
+    if (parseNumber(delBegin, delEnd, value))
+        stat.deletions = value;
+    else if (delEnd - delBegin != 1 || *delBegin != '-')
+        return false;
+
+    if (fileName)
+        stat.fileName = QString::fromUtf8(delEnd + 1, end - delEnd - 1);
+    return true;
+}
+
+QList<GitCommands::Stat> GitLogParser::parseStats(const QByteArray &data)
+{
+    QList<GitCommands::Stat> list;
+
+    auto c = data.constData();
+    const auto end = c + data.size();
+    while (c < end)
+    {
+        const auto lineEnd = findChar(c, end, '\n');
+
+        GitCommands::Stat s;
+        if (parseStat(c, lineEnd, s))
+            list << s;
+
+        c = lineEnd + 1;
+    }
+
+    return list;
+}
+
+void GitLogParser::feed(const QByteArray &data)
+{
+    mBuffer += data;
+
+    const auto last = mBuffer.lastIndexOf(recordSeparator);
+    if (last <= 0)
+        return;
+
+    auto c = mBuffer.constData();
+    const auto end = c + last;
+    while (c < end)
+    {
+        const auto recordEnd = findChar(c + 1, end, recordSeparator);
+        parseRecord(c, recordEnd);
+        c = recordEnd;
+    }
+
+    mBuffer.remove(0, last);
+}
+
+void GitLogParser::finish()
+{
+    auto c = mBuffer.constData();
+    const auto end = c + mBuffer.size();
+    while (c < end)
+    {
+        const auto recordEnd = findChar(c + 1, end, recordSeparator);
+        parseRecord(c, recordEnd);
+        c = recordEnd;
+    }
+
+    mBuffer.clear();
+}
+
+qint32 GitLogParser::count() const
+{
+    return mResults.count();
+}
+
+QList<GitCommands::CommitStat> GitLogParser::take()
+{
+    QList<GitCommands::CommitStat> res;
+    res.swap(mResults);
+    return res;
+}
+
+void GitLogParser::parseRecord(const char *begin, const char *end)
+{
+    if (*begin != recordSeparator)
+        return;
+    begin++;
+
+    const auto headerEnd = findChar(begin, end, '\n');
+
+    const char *fields[4];
+    const char *fieldEnds[4];
+    auto c = begin;
+    for (int i=0; i<4; i++)
+    {
+        if (c > headerEnd)
+            return;
+
+        fields[i] = c;
+        fieldEnds[i] = (i == 3? headerEnd : findChar(c, headerEnd, unitSeparator));
+        c = fieldEnds[i] + 1;
+    }
+
+    qint64 secs = 0;
+    if (!parseNumber(fields[1], fieldEnds[1], secs))
+        return;
+
+    GitCommands::CommitStat r;
+    r.commit.id = QString::fromLatin1(fields[0], fieldEnds[0] - fields[0]);
+    r.commit.datetime = QDateTime::fromSecsSinceEpoch(secs);
+    r.commit.commiter = QString::fromUtf8(fields[2], fieldEnds[2] - fields[2]);
+    r.commit.comment = QString::fromUtf8(fields[3], fieldEnds[3] - fields[3]);
+
+    c = headerEnd + 1;
+    while (c < end)
+    {
+        const auto lineEnd = findChar(c, end, '\n');
+
+        GitCommands::Stat s;
+        if (parseStat(c, lineEnd, s, false))
+        {
+            r.insertions += s.insertions;
+            r.deletions += s.deletions;
+            r.totalFiles++;
+        }
+        else if (lineEnd > c)
+            r.totalFiles++;
+
+        c = lineEnd + 1;
+    }
+
+    mResults << r;
+}
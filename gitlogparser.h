@@ -0,0 +1,41 @@
+#ifndef GITLOGPARSER_H
+#define GITLOGPARSER_H
+
+#include <QByteArray>
+#include <QList>
+
+#include "gitcommands.h"
+
+/*!
+ * Byte-level parser of the machine oriented "git log" format returned by
+ * GitLogParser::format(). Every commit starts with a record separator
+ * (0x1e) and its header fields are split by unit separators (0x1f); any
+ * following lines are numstat lines of that commit, or status lines when
+ * the log was produced with --name-status. Only the fields that
+ * end up in the result are converted to Qt types.
+ */
+class GitLogParser
+{
+public:
+    GitLogParser();
+    virtual ~GitLogParser();
+
+    static QString format();
+    static bool parseStat(const char *begin, const char *end, GitCommands::Stat &stat, bool fileName = true);
+    static QList<GitCommands::Stat> parseStats(const QByteArray &data);
+
+    void feed(const QByteArray &data);
+    void finish();
+
+    qint32 count() const;
+    QList<GitCommands::CommitStat> take();
+
+protected:
+    void parseRecord(const char *begin, const char *end);
+
+private:
+    QByteArray mBuffer;
+    QList<GitCommands::CommitStat> mResults;
+};
+
+#endif // GITLOGPARSER_H
@@ -0,0 +1,189 @@
+#include "gitscheduler.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+
+GitScheduler *GitScheduler::instance()
+{
+    static GitScheduler *res = new GitScheduler(QCoreApplication::instance());
+    return res;
+}
+
+GitScheduler::GitScheduler(QObject *parent)
+    : QObject(parent)
+{
+    mMaximumJobs = std::max(1, QThread::idealThreadCount());
+    mClock.start();
+}
+
+GitScheduler::~GitScheduler()
+{
+
+}
+
+void GitScheduler::start(const QString &group, QProcess *p)
+{
+    connect(p, &QObject::destroyed, this, &GitScheduler::release);
+    connect(p, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, p](){
+        release(p);
+    });
+    connect(p, &QProcess::errorOccurred, this, [this, p](QProcess::ProcessError error){
+        if (error == QProcess::FailedToStart)
+            release(p);
+    });
+
+    if (!mQueues.contains(group))
+        mGroups << group;
+
+    mQueues[group].enqueue(p);
+    mQueueDepth++;
+
+    schedule();
+}
+
+void GitScheduler::schedule()
+{
+    while (mRunning.count() < mMaximumJobs)
+    {
+        auto p = takeNext();
+        if (!p)
+            break;
+
+        mRunning.insert(p);
+        p->start();
+    }
+
+    Q_EMIT changed();
+}
+
+void GitScheduler::cancel(QProcess *process)
+{
+    // Forgotten right away, so a cancelled job can never be started.
+    // Freed slots are refilled later, after the caller cancelled the
+    // other jobs it is dropping.
+    process->disconnect(this);
+    if (mRunning.remove(process))
+        QTimer::singleShot(0, this, &GitScheduler::schedule);
+    else if (unqueue(process))
+        Q_EMIT changed();
+}
+
+bool GitScheduler::isContended(const QString &group) const
+{
+    // Only queued jobs of other repositories are waiting for a slot that
+    // group's long running jobs could give back. The priority repository
+    // is served first anyway.
+    if (group == mPriorityGroup)
+        return false;
+
+    for (const auto &g: mGroups)
+        if (g != group)
+            return true;
+
+    return false;
+}
+
+void GitScheduler::release(QObject *process)
+{
+    if (mRunning.remove(process))
+    {
+        mFinishes.enqueue(mClock.elapsed());
+        schedule();
+        return;
+    }
+
+    // Jobs deleted before they started are dropped from their queue
+    if (unqueue(static_cast<QProcess*>(process)))
+        Q_EMIT changed();
+}
+
+bool GitScheduler::unqueue(QProcess *process)
+{
+    for (qint32 i=0; i<mGroups.count(); i++)
+    {
+        auto &queue = mQueues[mGroups.at(i)];
+        if (!queue.removeOne(process))
+            continue;
+
+        mQueueDepth--;
+        if (queue.isEmpty())
+            removeGroup(i);
+        return true;
+    }
+
+    return false;
+}
+
+QProcess *GitScheduler::takeNext()
+{
+    const auto priority = mGroups.indexOf(mPriorityGroup);
+    if (priority >= 0)
+        return dequeue(priority);
+
+    if (mGroups.isEmpty())
+        return Q_NULLPTR;
+
+    mNextGroup = (mNextGroup + 1) % mGroups.count();
+    return dequeue(mNextGroup);
+}
+
+QProcess *GitScheduler::dequeue(qint32 groupIndex)
+{
+    auto &queue = mQueues[mGroups.at(groupIndex)];
+    auto p = queue.dequeue();
+    mQueueDepth--;
+
+    if (queue.isEmpty())
+        removeGroup(groupIndex);
+
+    return p;
+}
+
+void GitScheduler::removeGroup(qint32 groupIndex)
+{
+    mQueues.remove(mGroups.takeAt(groupIndex));
+    if (groupIndex <= mNextGroup)
+        mNextGroup--;
+}
+
+qint32 GitScheduler::maximumJobs() const
+{
+    return mMaximumJobs;
+}
+
+void GitScheduler::setMaximumJobs(qint32 newMaximumJobs)
+{
+    mMaximumJobs = std::max(1, newMaximumJobs);
+    schedule();
+}
+
+QString GitScheduler::priorityGroup() const
+{
+    return mPriorityGroup;
+}
+
+void GitScheduler::setPriorityGroup(const QString &newPriorityGroup)
+{
+    mPriorityGroup = newPriorityGroup;
+}
+
+qint32 GitScheduler::queueDepth() const
+{
+    return mQueueDepth;
+}
+
+qint32 GitScheduler::running() const
+{
+    return mRunning.count();
+}
+
+qreal GitScheduler::throughput() const
+{
+    const auto now = mClock.elapsed();
+    while (!mFinishes.isEmpty() && now - mFinishes.head() > throughputWindow)
+        mFinishes.dequeue();
+
+    return mFinishes.count() * 1000.0 / throughputWindow;
+}
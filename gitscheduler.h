@@ -0,0 +1,69 @@
+#ifndef GITSCHEDULER_H
+#define GITSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+
+class QProcess;
+
+/*!
+ * Process-wide scheduler of git processes, coprocesses included. It
+ * keeps at most maximumJobs() of them running, takes jobs round-robin
+ * from the queues of the different repositories so a huge one can't
+ * starve the others, and always serves the priority repository first.
+ */
+class GitScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static GitScheduler *instance();
+    virtual ~GitScheduler();
+
+    void start(const QString &group, QProcess *process);
+    void cancel(QProcess *process);
+    bool isContended(const QString &group) const;
+
+    qint32 maximumJobs() const;
+    void setMaximumJobs(qint32 newMaximumJobs);
+
+    QString priorityGroup() const;
+    void setPriorityGroup(const QString &newPriorityGroup);
+
+    qint32 queueDepth() const;
+    qint32 running() const;
+    qreal throughput() const;
+
+Q_SIGNALS:
+    void changed();
+
+protected:
+    GitScheduler(QObject *parent = nullptr);
+
+    void schedule();
+    void release(QObject *process);
+    bool unqueue(QProcess *process);
+    QProcess *takeNext();
+    QProcess *dequeue(qint32 groupIndex);
+    void removeGroup(qint32 groupIndex);
+
+private:
+    static const qint64 throughputWindow = 10000;
+
+    qint32 mMaximumJobs = 1;
+    QString mPriorityGroup;
+
+    QHash<QString, QQueue<QProcess*>> mQueues;
+    QStringList mGroups;
+    qint32 mNextGroup = -1;
+    qint32 mQueueDepth = 0;
+
+    QSet<QObject*> mRunning;
+
+    QElapsedTimer mClock;
+    mutable QQueue<qint64> mFinishes;
+};
+
+#endif // GITSCHEDULER_H
@@ -0,0 +1,122 @@
+#include "ingestionqueue.h"
+
+IngestionQueue::IngestionQueue(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+IngestionQueue::~IngestionQueue()
+{
+
+}
+
+void IngestionQueue::append(const GitCommands::Commit &commit)
+{
+    GitCommands::CommitStat c;
+    c.commit = commit;
+
+    mPending.enqueue(mOffset + mResults.count());
+    mResults << c;
+    mCompleted << false;
+    mTotal++;
+}
+
+void IngestionQueue::appendResolved(const GitCommands::CommitStat &commit)
+{
+    mResults << commit;
+    mCompleted << true;
+    mTotal++;
+    mDone++;
+}
+
+void IngestionQueue::close()
+{
+    mClosed = true;
+    if (isFinished())
+        Q_EMIT finished();
+}
+
+bool IngestionQueue::isClosed() const
+{
+    return mClosed;
+}
+
+bool IngestionQueue::hasNext() const
+{
+    return !mPending.isEmpty();
+}
+
+qint32 IngestionQueue::takeNext()
+{
+    if (!hasNext())
+        return -1;
+
+    mStarted++;
+    return mPending.dequeue();
+}
+
+const GitCommands::Commit &IngestionQueue::commit(qint32 index) const
+{
+    return mResults.at(index - mOffset).commit;
+}
+
+void IngestionQueue::complete(qint32 index, const QList<GitCommands::Stat> &stats)
+{
+    auto &r = mResults[index - mOffset];
+    r.totalFiles = stats.count();
+    for (const auto &s: stats)
+    {
+        r.insertions += s.insertions;
+        r.deletions += s.deletions;
+        r.approximate = r.approximate || s.approximate;
+    }
+    mCompleted[index - mOffset] = true;
+
+    mDone++;
+    mAnswered++;
+    Q_EMIT progress(mDone, mTotal);
+    if (isFinished())
+        Q_EMIT finished();
+}
+
+qint32 IngestionQueue::done() const
+{
+    return mDone;
+}
+
+qint32 IngestionQueue::total() const
+{
+    return mTotal;
+}
+
+qint32 IngestionQueue::inFlight() const
+{
+    return mStarted - mAnswered;
+}
+
+bool IngestionQueue::isFinished() const
+{
+    return mClosed && mDone == mTotal;
+}
+
+QList<GitCommands::CommitStat> IngestionQueue::takeCompleted()
+{
+    QList<GitCommands::CommitStat> res;
+    while (mFirst < mResults.count() && mCompleted.at(mFirst))
+    {
+        res << mResults.at(mFirst);
+        mResults[mFirst++] = GitCommands::CommitStat();
+    }
+
+    // The emptied front is cut off once it makes up half of the window
+    if (mFirst > 0 && mFirst * 2 >= mResults.count())
+    {
+        mResults.remove(0, mFirst);
+        mCompleted.remove(0, mFirst);
+        mOffset += mFirst;
+        mFirst = 0;
+    }
+
+    return res;
+}
@@ -0,0 +1,59 @@
+#ifndef INGESTIONQUEUE_H
+#define INGESTIONQUEUE_H
+
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+
+#include "gitcommands.h"
+
+/*!
+ * Commits waiting for their stats, in log order. Indexes are absolute
+ * and stay valid while a commit is pending. Completed commits at the
+ * front are handed out by takeCompleted() and dropped, so the queue only
+ * holds the window between the oldest pending commit and the newest one.
+ */
+class IngestionQueue : public QObject
+{
+    Q_OBJECT
+public:
+    IngestionQueue(QObject *parent = nullptr);
+    virtual ~IngestionQueue();
+
+    void append(const GitCommands::Commit &commit);
+    void appendResolved(const GitCommands::CommitStat &commit);
+    void close();
+    bool isClosed() const;
+
+    bool hasNext() const;
+    qint32 takeNext();
+
+    const GitCommands::Commit &commit(qint32 index) const;
+    void complete(qint32 index, const QList<GitCommands::Stat> &stats);
+
+    qint32 done() const;
+    qint32 total() const;
+    qint32 inFlight() const;
+    bool isFinished() const;
+
+    QList<GitCommands::CommitStat> takeCompleted();
+
+Q_SIGNALS:
+    void progress(qint32 done, qint32 total);
+    void finished();
+
+private:
+    QVector<GitCommands::CommitStat> mResults;
+    QVector<bool> mCompleted;
+    qint32 mFirst = 0;
+    qint32 mOffset = 0;
+
+    QQueue<qint32> mPending;
+    qint32 mTotal = 0;
+    qint32 mDone = 0;
+    qint32 mStarted = 0;
+    qint32 mAnswered = 0;
+    bool mClosed = false;
+};
+
+#endif // INGESTIONQUEUE_H
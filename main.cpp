@@ -54,6 +54,39 @@ int main(int argc, char *argv[])
         QCommandLineOption durationOption(QStringList() << "duration", QStringLiteral("Type of duration"), win.durations().join('|'), "weekly");
         parser.addOption(durationOption);
 
+        QCommandLineOption sinceOption(QStringList() << "since", QStringLiteral("Only load commits since this date."), "yyyy-MM-dd");
+        parser.addOption(sinceOption);
+
+        QCommandLineOption untilOption(QStringList() << "until", QStringLiteral("Only load commits until this date."), "yyyy-MM-dd");
+        parser.addOption(untilOption);
+
+        QCommandLineOption ingestionOption(QStringList() << "ingestion", QStringLiteral("How commit stats are read from git."), win.ingestionModes().join('|'), "single-pass");
+        parser.addOption(ingestionOption);
+
+        QCommandLineOption includeOption(QStringList() << "include", QStringLiteral("Only count paths matching this glob. Can be repeated."), "glob");
+        parser.addOption(includeOption);
+
+        QCommandLineOption excludeOption(QStringList() << "exclude", QStringLiteral("Never count paths matching this glob. Can be repeated."), "glob");
+        parser.addOption(excludeOption);
+
+        QCommandLineOption noRenamesOption(QStringList() << "no-renames", QStringLiteral("Disable rename and copy detection."));
+        parser.addOption(noRenamesOption);
+
+        QCommandLineOption noTextConvOption(QStringList() << "no-textconv", QStringLiteral("Don't run textconv filters, binary files count as changed files only."));
+        parser.addOption(noTextConvOption);
+
+        QCommandLineOption maxBlobSizeOption(QStringList() << "max-blob-size", QStringLiteral("Treat larger files as binary instead of diffing them."), "bytes");
+        parser.addOption(maxBlobSizeOption);
+
+        QCommandLineOption commitTimeoutOption(QStringList() << "commit-timeout", QStringLiteral("Count only changed files of a commit whose diff takes longer."), "ms");
+        parser.addOption(commitTimeoutOption);
+
+        QCommandLineOption historyOption(QStringList() << "history", QStringLiteral("Which commits of the history are counted."), win.historyModes().join('|'), "all");
+        parser.addOption(historyOption);
+
+        QCommandLineOption jobsOption(QStringList() << "j" << "jobs", QStringLiteral("Maximum number of parallel git jobs."), "count");
+        parser.addOption(jobsOption);
+
         parser.process(app);
 
         if (!parser.isSet(inputOption) || !parser.isSet(destOption))
@@ -84,6 +117,33 @@ int main(int argc, char *argv[])
                 format = QStringLiteral("csv");
         }
 
+        if (format == "json" || format == "csv") win.setExportDetails(true);
+        if (parser.isSet(jobsOption)) win.setMaximumJobs(parser.value(jobsOption).toInt());
+        if (parser.isSet(ingestionOption)) win.setIngestionMode(parser.value(ingestionOption));
+        if (parser.isSet(historyOption)) win.setHistoryMode(parser.value(historyOption));
+        if (parser.isSet(sinceOption) || parser.isSet(untilOption))
+        {
+            const auto since = QDate::fromString(parser.value(sinceOption), Qt::ISODate);
+            const auto until = QDate::fromString(parser.value(untilOption), Qt::ISODate);
+            if ((parser.isSet(sinceOption) && !since.isValid()) || (parser.isSet(untilOption) && !until.isValid()))
+            {
+                qDebug() << "Invalid date range: --since and --until take yyyy-MM-dd dates.";
+                return 1;
+            }
+
+            win.setLoadRange(since, until);
+        }
+        if (parser.isSet(noRenamesOption) || parser.isSet(noTextConvOption) || parser.isSet(maxBlobSizeOption) || parser.isSet(commitTimeoutOption))
+        {
+            GitCommands::DiffOptions diffOptions;
+            diffOptions.renames = !parser.isSet(noRenamesOption);
+            diffOptions.textConv = !parser.isSet(noTextConvOption);
+            diffOptions.bigFileThreshold = parser.value(maxBlobSizeOption).toLongLong();
+            diffOptions.timeout = parser.value(commitTimeoutOption).toInt();
+            win.setDiffOptions(diffOptions);
+        }
+        if (parser.isSet(includeOption) || parser.isSet(excludeOption))
+            win.setPathFilters(parser.values(includeOption), parser.values(excludeOption));
         if (duration.length()) win.setDuration(duration);
         if (data.length()) win.setDataType(data);
         if (view.length()) win.setViewType(view);
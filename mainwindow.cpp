@@ -1,6 +1,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "fonts/material/materialicons.h"
+#include "gitscheduler.h"
 
 #include <QFileDialog>
 #include <QLabel>
@@ -27,8 +28,24 @@ MainWindow::MainWindow(QWidget *parent) :
     mEndDate->setCalendarPopup(true);
     mEndDate->setEnabled(false);
 
+    mLoadRange = new QCheckBox(tr("Load only this range"));
+
     connect(mStartDate, &QDateEdit::editingFinished, this, [this](){ reloadAll(); });
     connect(mEndDate, &QDateEdit::editingFinished, this, [this](){ reloadAll(); });
+    connect(mStartDate, &QDateEdit::editingFinished, this, [this](){ if (mLoadRange->isChecked()) applyLoadRange(); });
+    connect(mEndDate, &QDateEdit::editingFinished, this, [this](){ if (mLoadRange->isChecked()) applyLoadRange(); });
+    connect(mLoadRange, &QCheckBox::toggled, this, &MainWindow::applyLoadRange);
+
+    mIncludePaths = new QLineEdit();
+    mIncludePaths->setPlaceholderText(tr("Include paths, e.g. src/**; docs/**"));
+    mIncludePaths->setClearButtonEnabled(true);
+
+    mExcludePaths = new QLineEdit();
+    mExcludePaths->setPlaceholderText(tr("Exclude paths, e.g. vendor/**; *.min.js"));
+    mExcludePaths->setClearButtonEnabled(true);
+
+    connect(mIncludePaths, &QLineEdit::editingFinished, this, &MainWindow::applyPathFilters);
+    connect(mExcludePaths, &QLineEdit::editingFinished, this, &MainWindow::applyPathFilters);
 
     auto dateWidget = new QWidget;
     auto dateLayout = new QHBoxLayout(dateWidget);
@@ -37,6 +54,9 @@ MainWindow::MainWindow(QWidget *parent) :
     dateLayout->addWidget(mStartDate);
     dateLayout->addWidget(new QLabel("To:"));
     dateLayout->addWidget(mEndDate);
+    dateLayout->addWidget(mLoadRange);
+    dateLayout->addWidget(mIncludePaths);
+    dateLayout->addWidget(mExcludePaths);
 
     ui->toolBar->addWidget(dateWidget);
 
@@ -48,6 +68,17 @@ MainWindow::MainWindow(QWidget *parent) :
 
     splitDockWidget(ui->projectsDock, ui->viewOptionsDock, Qt::Vertical);
 
+    connect(ui->listWidget, &QListWidget::currentItemChanged, this, [](QListWidgetItem *item){
+        GitScheduler::instance()->setPriorityGroup(item? item->data(Qt::UserRole).toString() : QString());
+    });
+    connect(GitScheduler::instance(), &GitScheduler::changed, this, [this](){
+        auto scheduler = GitScheduler::instance();
+        ui->progressBar->setToolTip(tr("Queued git jobs: %1\nRunning: %2\nThroughput: %3 jobs/s")
+                                    .arg(scheduler->queueDepth())
+                                    .arg(scheduler->running())
+                                    .arg(scheduler->throughput(), 0, 'f', 1));
+    });
+
     QSettings settings;
     resize(settings.value("MainWindow/size", size()).toSize());
     restoreState(settings.value("MainWindow/state", QByteArray()).toByteArray());
@@ -74,7 +105,7 @@ void MainWindow::setDataType(const QString &dataType)
     for (int i=0; i<ui->data->count(); i++)
         if (ui->data->itemText(i).toLower() == dataType.toLower())
         {
-            ui->data->setCurrentIndex(i);
+            setDataType(static_cast<CommitChartWidget::DataType>(i));
             break;
         }
 }
@@ -145,6 +176,109 @@ QStringList MainWindow::durations() const
     return list;
 }
 
+void MainWindow::setIngestionMode(const QString &ingestionMode)
+{
+    const auto modes = ingestionModes();
+    const auto idx = modes.indexOf(ingestionMode.toLower());
+    if (idx >= 0)
+        ui->chart->setIngestionMode( static_cast<CommitChartWidget::IngestionMode>(idx) );
+}
+
+QStringList MainWindow::ingestionModes() const
+{
+    return {QStringLiteral("single-pass"), QStringLiteral("per-commit"), QStringLiteral("coprocess"), QStringLiteral("sliced")};
+}
+
+void MainWindow::setHistoryMode(const QString &historyMode)
+{
+    const auto idx = historyModes().indexOf(historyMode.toLower());
+    if (idx < 0)
+        return;
+
+    ui->history->setCurrentIndex(idx);
+    ui->chart->setHistoryMode( static_cast<CommitChartWidget::HistoryMode>(idx) );
+}
+
+QStringList MainWindow::historyModes() const
+{
+    return {QStringLiteral("all"), QStringLiteral("first-parent"), QStringLiteral("no-merges")};
+}
+
+qint32 MainWindow::maximumJobs() const
+{
+    return ui->chart->maximumJobs();
+}
+
+void MainWindow::setMaximumJobs(qint32 newMaximumJobs)
+{
+    ui->chart->setMaximumJobs(newMaximumJobs);
+    GitScheduler::instance()->setMaximumJobs(newMaximumJobs);
+}
+
+void MainWindow::setLoadRange(const QDate &since, const QDate &until)
+{
+    QSignalBlocker blocker(mLoadRange);
+    if (since.isValid())
+        mStartDate->setDate(since);
+    if (until.isValid())
+        mEndDate->setDate(until);
+
+    mLoadRange->setChecked(since.isValid() || until.isValid());
+    ui->chart->setLoadRange(since.isValid()? QDateTime(since, QTime(0,0,0)) : QDateTime(),
+                            until.isValid()? QDateTime(until, QTime(23,59,59)) : QDateTime());
+}
+
+void MainWindow::applyLoadRange()
+{
+    const auto limited = mLoadRange->isChecked();
+    mStartDate->setEnabled(limited || mStartDate->isEnabled());
+    mEndDate->setEnabled(limited || mEndDate->isEnabled());
+
+    ui->chart->setLoadRange(limited? QDateTime(mStartDate->date(), QTime(0,0,0)) : QDateTime(),
+                            limited? QDateTime(mEndDate->date(), QTime(23,59,59)) : QDateTime());
+
+    for (const auto &path: ui->chart->paths())
+        ui->chart->load(path);
+}
+
+void MainWindow::setPathFilters(const QStringList &include, const QStringList &exclude)
+{
+    mIncludePaths->setText(include.join(QStringLiteral("; ")));
+    mExcludePaths->setText(exclude.join(QStringLiteral("; ")));
+    ui->chart->setPathFilters(include, exclude);
+}
+
+void MainWindow::setDiffOptions(const GitCommands::DiffOptions &newDiffOptions)
+{
+    ui->chart->setDiffOptions(newDiffOptions);
+}
+
+void MainWindow::setExportDetails(bool newExportDetails)
+{
+    ui->chart->setExportDetails(newExportDetails);
+}
+
+void MainWindow::applyPathFilters()
+{
+    // Globs are separated by semicolons, so they may contain spaces
+    const auto globs = [](const QString &text){
+        QStringList res;
+        for (const auto &glob: text.split(QLatin1Char(';'), Qt::SkipEmptyParts))
+            if (!glob.trimmed().isEmpty())
+                res << glob.trimmed();
+        return res;
+    };
+
+    const auto include = globs(mIncludePaths->text());
+    const auto exclude = globs(mExcludePaths->text());
+    if (include == ui->chart->includePaths() && exclude == ui->chart->excludePaths())
+        return;
+
+    ui->chart->setPathFilters(include, exclude);
+    for (const auto &path: ui->chart->paths())
+        ui->chart->load(path);
+}
+
 void MainWindow::on_actionAddProject_triggered()
 {
     QSettings settings;
@@ -172,18 +306,24 @@ void MainWindow::on_actionAddProject_triggered()
 
 void MainWindow::on_chart_loading(bool state, qint32 done, qint32 total)
 {
+    const auto repositories = ui->chart->loadingCount();
+
     ui->progressBar->setVisible(state);
     ui->progressBar->setMaximum(total);
     ui->progressBar->setValue(done);
+    ui->progressBar->setFormat(repositories > 1? tr("%1 repositories: %v/%m").arg(repositories) : QStringLiteral("%p%"));
 
     if (!state)
     {
         mBlockReloading = true;
-        mStartDate->setDateTime(ui->chart->minDate());
+        if (!mLoadRange->isChecked())
+        {
+            mStartDate->setDateTime(ui->chart->minDate());
+            mEndDate->setDateTime(ui->chart->maxDate());
+        }
         mStartDate->setEnabled(true);
-
-        mEndDate->setDateTime(ui->chart->maxDate());
         mEndDate->setEnabled(true);
+        mBlockReloading = false;
 
         Q_EMIT finished();
     }
@@ -194,12 +334,25 @@ void MainWindow::reloadAll(bool force)
     if (mBlockReloading && !force)
         return;
 
+    // Only a range narrowed in the editors limits the plot, otherwise it
+    // follows the loaded commits. The end date covers its whole day.
+    const auto narrowed = (mStartDate->isEnabled() && (mStartDate->date() > ui->chart->minDate().date() || mEndDate->date() < ui->chart->maxDate().date()));
     ui->chart->setSplineMode(ui->chartMode->currentIndex());
-    ui->chart->setStartDate(mStartDate->dateTime());
-    ui->chart->setEndDate(mEndDate->dateTime());
+    ui->chart->setStartDate(narrowed? QDateTime(mStartDate->date(), QTime(0,0,0)) : QDateTime());
+    ui->chart->setEndDate(narrowed? QDateTime(mEndDate->date(), QTime(23,59,59)) : QDateTime());
     ui->chart->setDuration( static_cast<AbstractChartWidget::Duration>(ui->duration->currentIndex()) );
     ui->chart->setViewType( static_cast<CommitChartWidget::ViewType>(ui->view->currentIndex()) );
     ui->chart->setDataType( static_cast<CommitChartWidget::DataType>(ui->data->currentIndex()) );
+
+    // Another history mode walks other commits, so repositories are loaded again
+    const auto history = static_cast<CommitChartWidget::HistoryMode>(ui->history->currentIndex());
+    if (history != ui->chart->historyMode())
+    {
+        ui->chart->setHistoryMode(history);
+        for (const auto &path: ui->chart->paths())
+            ui->chart->load(path);
+    }
+
     ui->chart->reload();
 }
 
@@ -227,6 +380,7 @@ bool MainWindow::addPath(const QString &path)
     ui->chart->load(path);
 
     auto item = new QListWidgetItem;
+    item->setData(Qt::UserRole, path);
 
     ui->listWidget->addItem(item);
 
@@ -251,6 +405,17 @@ bool MainWindow::addPath(const QString &path)
         visibleBtn->setProperty("disabled", disabled);
     });
 
+    auto refreshBtn = new QToolButton();
+    refreshBtn->setFont(font);
+    refreshBtn->setText(MaterialIcons::mdi_refresh);
+    refreshBtn->setAutoRaise(true);
+    refreshBtn->setFixedWidth(22);
+
+    connect(refreshBtn, &QPushButton::clicked, this, [path, visibleBtn, this](){
+        if (!visibleBtn->property("disabled").toBool())
+            ui->chart->load(path);
+    });
+
     auto delBtn = new QToolButton();
     delBtn->setFont(font);
     delBtn->setText(MaterialIcons::mdi_delete);
@@ -269,6 +434,7 @@ bool MainWindow::addPath(const QString &path)
     layout->addWidget(visibleBtn);
     layout->addWidget(new QLabel(inf.dirName()));
     layout->addStretch();
+    layout->addWidget(refreshBtn);
     layout->addWidget(delBtn);
 
     ui->listWidget->setItemWidget(item, wgt);
@@ -1,8 +1,10 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDateEdit>
+#include <QLineEdit>
 #include <QMainWindow>
 
 #include "commitchartwidget.h"
@@ -34,6 +36,20 @@ public:
     void setDuration(const QString &duration);
     QStringList durations() const;
 
+    void setIngestionMode(const QString &ingestionMode);
+    QStringList ingestionModes() const;
+
+    void setHistoryMode(const QString &historyMode);
+    QStringList historyModes() const;
+
+    qint32 maximumJobs() const;
+    void setMaximumJobs(qint32 newMaximumJobs);
+
+    void setLoadRange(const QDate &since, const QDate &until);
+    void setPathFilters(const QStringList &include, const QStringList &exclude);
+    void setDiffOptions(const GitCommands::DiffOptions &newDiffOptions);
+    void setExportDetails(bool newExportDetails);
+
 Q_SIGNALS:
     void finished();
 
@@ -45,6 +61,8 @@ public Q_SLOTS:
     bool addPath(const QString &path);
 
 private Q_SLOTS:
+    void applyLoadRange();
+    void applyPathFilters();
     void on_actionAddProject_triggered();
     void on_chart_loading(bool state, qint32 done, qint32 total);
     void on_applyBtn_clicked();
@@ -58,6 +76,9 @@ private:
     bool mBlockReloading = false;
     QDateEdit *mStartDate;
     QDateEdit *mEndDate;
+    QCheckBox *mLoadRange;
+    QLineEdit *mIncludePaths;
+    QLineEdit *mExcludePaths;
 };
 
 #endif // MAINWINDOW_H
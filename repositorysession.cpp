@@ -0,0 +1,475 @@
+#include "repositorysession.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <memory>
+
+QString RepositorySession::Options::key() const
+{
+    return QStringLiteral("%1:%2:%3:%4").arg(since.isValid()? since.toSecsSinceEpoch() : -1)
+                                        .arg(until.isValid()? until.toSecsSinceEpoch() : -1)
+                                        .arg(static_cast<int>(history))
+                                        .arg(fingerprint());
+}
+
+QStringList RepositorySession::Options::pathspecs() const
+{
+    QStringList res;
+    for (const auto &p: includePaths)
+        res << QStringLiteral(":(glob)") + p;
+    for (const auto &p: excludePaths)
+        res << QStringLiteral(":(exclude,glob)") + p;
+    return res;
+}
+
+QString RepositorySession::Options::fingerprint() const
+{
+    auto res = pathspecs();
+    if (!diffOptions.renames)
+        res << QStringLiteral("no-renames");
+    if (!diffOptions.textConv)
+        res << QStringLiteral("no-textconv");
+    if (diffOptions.bigFileThreshold > 0)
+        res << QStringLiteral("big-file-threshold=%1").arg(diffOptions.bigFileThreshold);
+    return res.join(QStringLiteral("\n"));
+}
+
+RepositorySession::RepositorySession(const QString &path, QObject *parent)
+    : QObject(parent),
+      mPath(path),
+      mCache(path)
+{
+    mGit = new GitCommands(path, this);
+}
+
+RepositorySession::~RepositorySession()
+{
+    cancel();
+}
+
+void RepositorySession::load(const Options &options)
+{
+    cancel();
+
+    mOptions = options;
+    mGit->setCoprocessCount(mOptions.maximumJobs);
+    mGit->setPathspecs(mOptions.pathspecs());
+    mGit->setDiffOptions(mOptions.diffOptions);
+
+    mLoading = true;
+    mFailed = false;
+    setProgress(0, 0);
+
+    mGit->revParse(QStringLiteral("HEAD"), [this](const QString &head){
+        if (head.isEmpty())
+        {
+            finish();
+            return;
+        }
+
+        // The length of HEAD tells SHA-1 and SHA-256 repositories apart
+        const qint32 idSize = head.length() / 2;
+        openCache(idSize);
+
+        // A tip ingested with other options (e.g. another date range) or
+        // with less detailed stats can't be extended, so the repository is
+        // loaded from scratch. Otherwise new commits keep the table's level.
+        const auto key = mOptions.key();
+        const auto reusable = (mTipKey == key && mTipStatLevel >= mOptions.statLevel && mTable.idSize() == idSize);
+        const auto tip = (reusable? mTip : QString());
+        mStatLevel = (reusable? mTipStatLevel : mOptions.statLevel);
+        if (tip == head)
+        {
+            finish();
+            return;
+        }
+
+        GitCommands::LogOptions options;
+        options.revisions = head;
+        options.since = mOptions.since;
+        options.until = mOptions.until;
+        options.firstParent = (mOptions.history == FirstParent);
+        options.noMerges = (mOptions.history == NoMerges);
+        if (tip.isEmpty())
+        {
+            clearTable();
+            mTable.setIdSize(idSize);
+            ingest(head, options);
+            return;
+        }
+
+        // Only the commits added since the last ingested tip are asked
+        // from git, unless the history has been rewritten meanwhile.
+        mGit->isAncestor(tip, head, [this, head, tip, options](bool ancestor){
+            auto opts = options;
+            if (ancestor)
+                opts.revisions = tip + QStringLiteral("..") + head;
+            else
+                clearTable();
+
+            ingest(head, opts);
+        });
+    });
+}
+
+void RepositorySession::openCache(qint32 idSize)
+{
+    // Stats of other path filters or diff options live in their own cache file
+    const auto fingerprint = mOptions.fingerprint();
+    if (fingerprint != mCacheFingerprint || idSize != mCacheIdSize)
+    {
+        mCache.flush();
+        mCache = StatsCache(mPath, fingerprint, idSize);
+        mCacheFingerprint = fingerprint;
+        mCacheIdSize = idSize;
+        mCacheLoaded = false;
+    }
+
+    if (!mCacheLoaded)
+    {
+        mCache.load();
+        mCacheLoaded = true;
+    }
+}
+
+void RepositorySession::clearTable()
+{
+    // Rows only ever get appended within a generation. The ingested tip
+    // is gone with them, so a load cancelled before it finishes is never
+    // taken for an up to date one.
+    mTable.clear();
+    mGeneration++;
+    mTip.clear();
+    mTipKey.clear();
+    mTipStatLevel = TimesOnly;
+}
+
+void RepositorySession::ingest(const QString &head, const GitCommands::LogOptions &options)
+{
+    if (mStatLevel <= NoStats)
+        ingestMetadata(head, options);
+    else if (mStatLevel == FileStats)
+        ingestFiles(head, options);
+    else if (!mCache.isEmpty())
+        ingestCached(head, options);
+    else if (mOptions.ingestionMode == Sliced)
+        ingestSliced(head, options);
+    else if (mOptions.ingestionMode == SinglePass)
+        ingestSingle(head, options);
+    else
+        ingestCached(head, options);
+}
+
+void RepositorySession::ingestSingle(const QString &head, const GitCommands::LogOptions &options)
+{
+    mGit->listCommitStats(options, [this](const QList<GitCommands::CommitStat> &list){
+        append(list);
+        setProgress(mDone + list.count(), 0);
+    }, [this, head](bool ok){
+        mFailed |= !ok;
+        finishIngestion(head);
+    }, [this, head, options](){
+        // A commit took longer than the timeout. The commits streamed so
+        // far are in the stats cache and the table skips them, so only the
+        // rest are diffed, each with its own time budget.
+        ingestCached(head, options);
+    });
+}
+
+void RepositorySession::ingestSliced(const QString &head, const GitCommands::LogOptions &options)
+{
+    mGit->listCommitIds(options, [this, head, options](const QStringList &ids){
+        // The listed commits are cut into runs of about the same size, each
+        // diffed by its own git log. Runs are ordered newest first, like git
+        // log, and cover every listed commit whatever its date.
+        const qint32 slices = std::min<qint32>(mOptions.maximumJobs, ids.count());
+        if (slices <= 1)
+        {
+            ingestSingle(head, options);
+            return;
+        }
+
+        struct Merge {
+            QVector<QList<GitCommands::CommitStat>> results;
+            QVector<bool> finished;
+            qint32 next = 0;
+            bool stalled = false;
+        };
+
+        auto merge = std::make_shared<Merge>();
+        merge->results.resize(slices);
+        merge->finished.resize(slices);
+
+        setProgress(0, ids.count());
+        for (qint32 k=0; k<slices; k++)
+        {
+            const qint32 from = k * ids.count() / slices;
+            const qint32 to = (k + 1) * ids.count() / slices;
+
+            mGit->listCommitStats(ids.mid(from, to - from), [this, merge, k](const QList<GitCommands::CommitStat> &list){
+                if (merge->next == k)
+                    append(list);
+                else
+                    merge->results[k] << list;
+
+                setProgress(mDone + list.count(), mTotal);
+            }, [this, merge, k, slices, head](bool ok){
+                mFailed |= !ok;
+                merge->finished[k] = true;
+                while (merge->next < slices && merge->finished.at(merge->next))
+                {
+                    merge->next++;
+                    if (merge->next < slices)
+                    {
+                        append(merge->results.at(merge->next));
+                        merge->results[merge->next].clear();
+                    }
+                }
+
+                if (merge->next == slices)
+                    finishIngestion(head);
+            }, [this, merge, head, options](){
+                // One slice is stuck on a slow commit. All slices stop and
+                // the commits not diffed yet go through the per-commit path.
+                if (merge->stalled)
+                    return;
+
+                merge->stalled = true;
+                mGit->cancel(mPath);
+                for (const auto &list: merge->results)
+                    for (const auto &c: list)
+                        if (!c.approximate && !mFailed)
+                            mCache.insert(c);
+
+                ingestCached(head, options);
+            });
+        }
+    });
+}
+
+void RepositorySession::ingestCached(const QString &head, const GitCommands::LogOptions &options)
+{
+    auto queue = new IngestionQueue(this);
+    mQueue = queue;
+
+    // Completed commits reach the table as soon as all older ones did
+    connect(queue, &IngestionQueue::progress, this, [this, queue](qint32 done, qint32 total){
+        append(queue->takeCompleted());
+        setProgress(done, total);
+    });
+    connect(queue, &IngestionQueue::finished, this, [this, queue, head](){
+        append(queue->takeCompleted());
+        queue->deleteLater();
+        finishIngestion(head);
+    });
+
+    mGit->listCommits(options, [this, queue](const QList<GitCommands::Commit> &list){
+        for (const auto &c: list)
+        {
+            GitCommands::CommitStat s;
+            s.commit = c;
+            if (mCache.find(s))
+                queue->appendResolved(s);
+            else
+                queue->append(c);
+        }
+
+        append(queue->takeCompleted());
+        setProgress(queue->done(), queue->total());
+        loadCommits(queue);
+    }, [this, queue](bool ok){
+        mFailed |= !ok;
+        queue->close();
+    });
+}
+
+void RepositorySession::ingestMetadata(const QString &head, const GitCommands::LogOptions &options)
+{
+    auto callback = [this](const QList<GitCommands::Commit> &list){
+        for (const auto &c: list)
+        {
+            GitCommands::CommitStat s;
+            s.commit = c;
+            mTable.append(s);
+        }
+
+        setProgress(mDone + list.count(), 0);
+    };
+    auto finished = [this, head](bool ok){
+        mFailed |= !ok;
+        finishIngestion(head);
+    };
+
+    // Without authors the commit-graph file is enough, when there is one
+    if (mStatLevel == TimesOnly)
+        mGit->listGraphCommits(options, callback, finished);
+    else
+        mGit->listCommits(options, callback, finished);
+}
+
+void RepositorySession::ingestFiles(const QString &head, const GitCommands::LogOptions &options)
+{
+    // File counts carry no line stats, so they stay out of the stats cache
+    mGit->listCommitFiles(options, [this](const QList<GitCommands::CommitStat> &list){
+        for (const auto &c: list)
+            mTable.append(c);
+
+        setProgress(mDone + list.count(), 0);
+    }, [this, head](bool ok){
+        mFailed |= !ok;
+        finishIngestion(head);
+    });
+}
+
+void RepositorySession::append(const QList<GitCommands::CommitStat> &list)
+{
+    // Once git failed, the stats of this load are shown but not trusted
+    for (const auto &c: list)
+    {
+        mTable.append(c);
+        if (!c.approximate && !mFailed)
+            mCache.insert(c);
+    }
+}
+
+void RepositorySession::finishIngestion(const QString &head)
+{
+    mCache.flush();
+    mTipStatLevel = mStatLevel;
+
+    // A table with commits git failed on is never extended, the next load
+    // starts over instead.
+    if (mFailed)
+    {
+        qDebug() << "git failed while loading" << mPath;
+        mTip.clear();
+        mTipKey.clear();
+    }
+    else
+    {
+        mTip = head;
+        mTipKey = mOptions.key();
+    }
+
+    finish();
+}
+
+void RepositorySession::cancel()
+{
+    if (!mLoading)
+        return;
+
+    mGit->cancel(mPath);
+    if (mQueue)
+        delete mQueue;
+
+    mLoading = false;
+    setProgress(0, 0);
+}
+
+void RepositorySession::loadCommits(IngestionQueue *queue)
+{
+    // Commits missing from the stats cache of a single-pass load are
+    // looked up through the coprocesses as well.
+    const auto coprocess = (mOptions.ingestionMode != PerCommit);
+    const qint32 limit = (coprocess? mOptions.maximumJobs * coprocessBatchSize : mOptions.maximumJobs);
+    while (queue->inFlight() < limit && queue->hasNext())
+    {
+        if (coprocess)
+            loadNextBatch(queue);
+        else
+            loadNext(queue);
+    }
+}
+
+void RepositorySession::loadNext(IngestionQueue *queue)
+{
+    const auto idx = queue->takeNext();
+    if (idx < 0)
+        return;
+
+    mGit->commitStat(queue->commit(idx).id, [this, queue, idx](const QList<GitCommands::Stat> &stats, bool ok){
+        mFailed |= !ok;
+        queue->complete(idx, stats);
+        loadCommits(queue);
+    });
+}
+
+void RepositorySession::loadNextBatch(IngestionQueue *queue)
+{
+    QStringList commits;
+    QHash<QString, qint32> indexes;
+    while (commits.count() < coprocessBatchSize && queue->hasNext())
+    {
+        const auto idx = queue->takeNext();
+        commits << queue->commit(idx).id;
+        indexes[commits.last()] = idx;
+    }
+
+    if (commits.isEmpty())
+        return;
+
+    // A commit over the diff timeout is answered after the ones queued
+    // behind it, so answers find their row by commit id.
+    auto remains = std::make_shared<QHash<QString, qint32>>(indexes);
+    mGit->queryStats(commits, [this, queue, remains](const QString &commit, const QList<GitCommands::Stat> &stats, bool ok){
+        const auto idx = remains->take(commit);
+        const auto last = remains->isEmpty();
+
+        mFailed |= !ok;
+        queue->complete(idx, stats);
+        if (last)
+            loadCommits(queue);
+    });
+}
+
+void RepositorySession::setProgress(qint32 done, qint32 total)
+{
+    mDone = done;
+    mTotal = total;
+    Q_EMIT progress(mDone, mTotal);
+}
+
+void RepositorySession::finish()
+{
+    mLoading = false;
+    mDone = 0;
+    mTotal = 0;
+    Q_EMIT finished();
+}
+
+QString RepositorySession::path() const
+{
+    return mPath;
+}
+
+const CommitTable &RepositorySession::table() const
+{
+    return mTable;
+}
+
+qint32 RepositorySession::generation() const
+{
+    return mGeneration;
+}
+
+RepositorySession::StatLevel RepositorySession::statLevel() const
+{
+    return mTipStatLevel;
+}
+
+bool RepositorySession::isLoading() const
+{
+    return mLoading;
+}
+
+qint32 RepositorySession::done() const
+{
+    return mDone;
+}
+
+qint32 RepositorySession::total() const
+{
+    return mTotal;
+}
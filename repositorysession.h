@@ -0,0 +1,120 @@
+#ifndef REPOSITORYSESSION_H
+#define REPOSITORYSESSION_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QPointer>
+
+#include "gitcommands.h"
+#include "ingestionqueue.h"
+#include "committable.h"
+#include "statscache.h"
+
+/*!
+ * Loading state of one repository: its own GitCommands, commit store,
+ * stats cache, last ingested tip and progress. Sessions of different
+ * repositories are independent, so several of them can load at once.
+ */
+class RepositorySession : public QObject
+{
+    Q_OBJECT
+public:
+    enum IngestionMode {
+        SinglePass = 0,
+        PerCommit = 1,
+        Coprocess = 2,
+        Sliced = 3,
+    };
+
+    enum HistoryMode {
+        AllCommits = 0,
+        FirstParent = 1,
+        NoMerges = 2,
+    };
+
+    enum StatLevel {
+        TimesOnly = 0,
+        NoStats = 1,
+        FileStats = 2,
+        LineStats = 3,
+    };
+
+    struct Options {
+        IngestionMode ingestionMode = SinglePass;
+        StatLevel statLevel = LineStats;
+        HistoryMode history = AllCommits;
+        qint32 maximumJobs = 1;
+        QDateTime since;
+        QDateTime until;
+        QStringList includePaths;
+        QStringList excludePaths;
+        GitCommands::DiffOptions diffOptions;
+
+        QStringList pathspecs() const;
+        QString fingerprint() const;
+
+        QString key() const;
+    };
+
+    RepositorySession(const QString &path, QObject *parent = nullptr);
+    virtual ~RepositorySession();
+
+    void load(const Options &options);
+    void cancel();
+
+    QString path() const;
+    const CommitTable &table() const;
+    qint32 generation() const;
+    StatLevel statLevel() const;
+
+    bool isLoading() const;
+    qint32 done() const;
+    qint32 total() const;
+
+Q_SIGNALS:
+    void progress(qint32 done, qint32 total);
+    void finished();
+
+protected:
+    void openCache(qint32 idSize);
+    void clearTable();
+    void ingest(const QString &head, const GitCommands::LogOptions &options);
+    void ingestSingle(const QString &head, const GitCommands::LogOptions &options);
+    void ingestSliced(const QString &head, const GitCommands::LogOptions &options);
+    void ingestCached(const QString &head, const GitCommands::LogOptions &options);
+    void ingestMetadata(const QString &head, const GitCommands::LogOptions &options);
+    void ingestFiles(const QString &head, const GitCommands::LogOptions &options);
+    void append(const QList<GitCommands::CommitStat> &list);
+    void finishIngestion(const QString &head);
+    void loadCommits(IngestionQueue *queue);
+    void loadNext(IngestionQueue *queue);
+    void loadNextBatch(IngestionQueue *queue);
+    void setProgress(qint32 done, qint32 total);
+    void finish();
+
+private:
+    static const qint32 coprocessBatchSize = 256;
+
+    QString mPath;
+    GitCommands *mGit;
+    CommitTable mTable;
+    qint32 mGeneration = 0;
+    StatsCache mCache;
+    bool mCacheLoaded = false;
+    QString mCacheFingerprint;
+    qint32 mCacheIdSize = 20;
+
+    QString mTip;
+    QString mTipKey;
+    StatLevel mTipStatLevel = TimesOnly;
+    StatLevel mStatLevel = TimesOnly;
+
+    Options mOptions;
+    QPointer<IngestionQueue> mQueue;
+    bool mLoading = false;
+    bool mFailed = false;
+    qint32 mDone = 0;
+    qint32 mTotal = 0;
+};
+
+#endif // REPOSITORYSESSION_H
@@ -0,0 +1,190 @@
+#include "seriesrollup.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+qint64 minTime(const QVector<AbstractChartWidget::PointValue> &points)
+{
+    auto res = std::numeric_limits<qint64>::max();
+    for (const auto &p: points)
+        res = std::min(res, p.time);
+    return points.isEmpty()? 0 : res;
+}
+
+qint64 maxTime(const QVector<AbstractChartWidget::PointValue> &points)
+{
+    auto res = std::numeric_limits<qint64>::min();
+    for (const auto &p: points)
+        res = std::max(res, p.time);
+    return points.isEmpty()? 0 : res;
+}
+}
+
+SeriesRollup::SeriesRollup(const QVector<AbstractChartWidget::PointValue> &points)
+    : mFirstTime(minTime(points)),
+      mLastTime(maxTime(points)),
+      mDayBuckets(AbstractChartWidget::Day, mFirstTime, mLastTime)
+{
+    add(points);
+}
+
+SeriesRollup::SeriesRollup(const SeriesRollup &base, const QVector<AbstractChartWidget::PointValue> &points)
+    : SeriesRollup(base)
+{
+    add(points);
+}
+
+SeriesRollup::~SeriesRollup()
+{
+
+}
+
+bool SeriesRollup::isEmpty() const
+{
+    return mDays.isEmpty();
+}
+
+QVector<SeriesRollup::Bucket> SeriesRollup::buckets(AbstractChartWidget::Duration duration, qint64 from, qint64 to) const
+{
+    QVector<Bucket> res;
+    qint32 begin, end;
+    if (!dayRange(from, to, begin, end))
+        return res;
+
+    // Running totals start at the beginning of the range
+    const auto base = mPrefix.at(begin);
+    if (duration == AbstractChartWidget::Day)
+    {
+        for (auto i = begin; i < end; i++)
+        {
+            // Jumps over days without any point
+            i = static_cast<qint32>(std::upper_bound(mUsedPrefix.constBegin() + i, mUsedPrefix.constEnd(), mUsedPrefix.at(i)) - mUsedPrefix.constBegin()) - 1;
+            if (i >= end)
+                break;
+
+            res << Bucket{mDayBuckets.date(mFirstDay + i), mDays.at(i), mPrefix.at(i+1) - base};
+        }
+        return res;
+    }
+
+    const auto &l = mLevels[duration];
+    const TimeBuckets keys(duration, 0, 0);
+
+    auto i = static_cast<qint32>(std::upper_bound(l.bounds.constBegin(), l.bounds.constEnd(), begin) - l.bounds.constBegin()) - 1;
+    for (; i+1 < l.bounds.count() && l.bounds.at(i) < end; i++)
+    {
+        const auto b = std::max(l.bounds.at(i), begin);
+        const auto e = std::min(l.bounds.at(i+1), end);
+        if (used(b, e))
+            res << Bucket{keys.date(l.firstKey + i), sum(b, e), mPrefix.at(e) - base};
+    }
+
+    return res;
+}
+
+void SeriesRollup::add(const QVector<AbstractChartWidget::PointValue> &points)
+{
+    if (points.isEmpty())
+        return;
+
+    // Day keys don't depend on the range, only local time offsets do
+    const auto firstTime = (isEmpty()? minTime(points) : std::min(mFirstTime, minTime(points)));
+    const auto lastTime = (isEmpty()? maxTime(points) : std::max(mLastTime, maxTime(points)));
+    if (firstTime != mFirstTime || lastTime != mLastTime)
+    {
+        mFirstTime = firstTime;
+        mLastTime = lastTime;
+        mDayBuckets = TimeBuckets(AbstractChartWidget::Day, firstTime, lastTime);
+    }
+
+    QVector<qint64> keys(points.count());
+    auto firstDay = (isEmpty()? std::numeric_limits<qint64>::max() : mFirstDay);
+    auto lastDay = (isEmpty()? std::numeric_limits<qint64>::min() : mFirstDay + mDays.count() - 1);
+    for (qint32 i=0; i<points.count(); i++)
+    {
+        keys[i] = mDayBuckets.key(points.at(i).time);
+        firstDay = std::min(firstDay, keys.at(i));
+        lastDay = std::max(lastDay, keys.at(i));
+    }
+
+    // Existing bins move by the days the range grew at its front
+    QVector<qreal> days(lastDay - firstDay + 1);
+    QVector<bool> usedDays(days.count());
+    const auto shift = (isEmpty()? 0 : mFirstDay - firstDay);
+    for (qint32 i=0; i<mDays.count(); i++)
+    {
+        days[i + shift] = mDays.at(i);
+        usedDays[i + shift] = used(i, i+1);
+    }
+    for (qint32 i=0; i<points.count(); i++)
+    {
+        const auto idx = keys.at(i) - firstDay;
+        days[idx] += points.at(i).value;
+        usedDays[idx] = true;
+    }
+
+    // Prefixes and levels cost one pass over the days, not the points
+    mFirstDay = firstDay;
+    mDays = days;
+    mPrefix = QVector<qreal>(mDays.count() + 1);
+    mUsedPrefix = QVector<qint32>(mDays.count() + 1);
+    for (qint32 i=0; i<mDays.count(); i++)
+    {
+        mPrefix[i+1] = mPrefix.at(i) + mDays.at(i);
+        mUsedPrefix[i+1] = mUsedPrefix.at(i) + (usedDays.at(i)? 1 : 0);
+    }
+
+    buildLevel(AbstractChartWidget::Week);
+    buildLevel(AbstractChartWidget::Month);
+    buildLevel(AbstractChartWidget::Year);
+}
+
+qreal SeriesRollup::total(qint64 from, qint64 to) const
+{
+    qint32 begin, end;
+    return dayRange(from, to, begin, end)? sum(begin, end) : 0;
+}
+
+void SeriesRollup::buildLevel(AbstractChartWidget::Duration duration)
+{
+    // Every bucket of a level covers a contiguous run of daily bins
+    auto &l = mLevels[duration];
+    l = Level();
+    const TimeBuckets keys(duration, 0, 0);
+    const qint64 count = mDays.count();
+    const auto lastKey = keys.dayKey(mFirstDay + count - 1);
+    l.firstKey = keys.dayKey(mFirstDay);
+    for (auto k = l.firstKey; k <= lastKey; k++)
+        l.bounds << static_cast<qint32>(std::max<qint64>(0, std::min(count, keys.firstDay(k) - mFirstDay)));
+    l.bounds << static_cast<qint32>(count);
+}
+
+bool SeriesRollup::dayRange(qint64 from, qint64 to, qint32 &begin, qint32 &end) const
+{
+    if (isEmpty() || from > to)
+        return false;
+
+    const qint64 count = mDays.count();
+    const auto fromDay = (from == std::numeric_limits<qint64>::min()? mFirstDay : mDayBuckets.key(from));
+    const auto toDay = (to == std::numeric_limits<qint64>::max()? mFirstDay + count - 1 : mDayBuckets.key(to));
+    begin = static_cast<qint32>(std::max<qint64>(0, std::min(count, fromDay - mFirstDay)));
+    end = static_cast<qint32>(std::max<qint64>(0, std::min(count, toDay - mFirstDay + 1)));
+    if (begin >= end || !used(begin, end))
+        return false;
+
+    // Narrowed to the first and last days that have points
+    begin = static_cast<qint32>(std::upper_bound(mUsedPrefix.constBegin(), mUsedPrefix.constEnd(), mUsedPrefix.at(begin)) - mUsedPrefix.constBegin()) - 1;
+    end = static_cast<qint32>(std::lower_bound(mUsedPrefix.constBegin(), mUsedPrefix.constEnd(), mUsedPrefix.at(end)) - mUsedPrefix.constBegin());
+    return true;
+}
+
+qreal SeriesRollup::sum(qint32 begin, qint32 end) const
+{
+    return mPrefix.at(end) - mPrefix.at(begin);
+}
+
+bool SeriesRollup::used(qint32 begin, qint32 end) const
+{
+    return mUsedPrefix.at(end) > mUsedPrefix.at(begin);
+}
@@ -0,0 +1,61 @@
+#ifndef SERIESROLLUP_H
+#define SERIESROLLUP_H
+
+#include <QDateTime>
+#include <QVector>
+
+#include "abstractchartwidget.h"
+#include "timebuckets.h"
+
+/*!
+ * Multi-resolution sums of one chart series. Points are binned into daily
+ * sums once; weekly, monthly and yearly levels are derived from the daily
+ * bins when the rollup is built, so switching durations never goes back
+ * to the raw points. A built rollup is never modified, which lets plot
+ * workers share it across threads; new points make a merged copy, which
+ * only touches the daily bins. Prefix sums of the daily bins answer range
+ * totals and running totals from any start date by subtraction, and the
+ * first and last used days of a range are found by binary search over the
+ * prefix counts of used days.
+ */
+class SeriesRollup
+{
+public:
+    struct Bucket {
+        QDateTime date;
+        qreal value = 0;
+        qreal total = 0;
+    };
+
+    SeriesRollup(const QVector<AbstractChartWidget::PointValue> &points);
+    SeriesRollup(const SeriesRollup &base, const QVector<AbstractChartWidget::PointValue> &points);
+    virtual ~SeriesRollup();
+
+    bool isEmpty() const;
+    QVector<Bucket> buckets(AbstractChartWidget::Duration duration, qint64 from, qint64 to) const;
+    qreal total(qint64 from, qint64 to) const;
+
+protected:
+    struct Level {
+        qint64 firstKey = 0;
+        QVector<qint32> bounds;
+    };
+
+    void add(const QVector<AbstractChartWidget::PointValue> &points);
+    void buildLevel(AbstractChartWidget::Duration duration);
+    bool dayRange(qint64 from, qint64 to, qint32 &begin, qint32 &end) const;
+    qreal sum(qint32 begin, qint32 end) const;
+    bool used(qint32 begin, qint32 end) const;
+
+private:
+    qint64 mFirstTime = 0;
+    qint64 mLastTime = 0;
+    TimeBuckets mDayBuckets;
+    qint64 mFirstDay = 0;
+    QVector<qreal> mDays;
+    QVector<qreal> mPrefix;
+    QVector<qint32> mUsedPrefix;
+    Level mLevels[4];
+};
+
+#endif // SERIESROLLUP_H
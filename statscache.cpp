@@ -0,0 +1,142 @@
+#include "statscache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+
+namespace {
+const QByteArray cacheMagic = QByteArrayLiteral("GCDS0001");
+const qint32 valuesSize = 3 * sizeof(qint32);
+}
+
+StatsCache::StatsCache()
+{
+
+}
+
+StatsCache::StatsCache(const QString &repositoryPath, const QString &fingerprint, qint32 idSize)
+    : mIdSize(idSize)
+{
+    auto name = QDir(repositoryPath).absolutePath();
+    if (fingerprint.length())
+        name += QStringLiteral("\n") + fingerprint;
+    if (idSize != 20)
+        name += QStringLiteral("\nid-size=%1").arg(idSize);
+
+    const auto dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/stats");
+    const auto key = QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Md5).toHex();
+    mFileName = dir + QStringLiteral("/") + QString::fromLatin1(key) + QStringLiteral(".cache");
+}
+
+StatsCache::~StatsCache()
+{
+
+}
+
+bool StatsCache::load()
+{
+    QFile f(mFileName);
+    if (!f.open(QFile::ReadOnly))
+        return false;
+
+    const auto data = f.readAll();
+    f.close();
+
+    if (!data.startsWith(cacheMagic))
+        return false;
+
+    const auto idSize = mIdSize;
+    const qint32 recordSize = idSize + valuesSize;
+    const auto count = (data.size() - cacheMagic.size()) / recordSize;
+    mEntries.reserve(mEntries.count() + count);
+
+    auto c = data.constData() + cacheMagic.size();
+    for (qint32 i=0; i<count; i++, c += recordSize)
+    {
+        Entry e;
+        e.insertions = qFromLittleEndian<qint32>(c + idSize);
+        e.deletions = qFromLittleEndian<qint32>(c + idSize + 4);
+        e.totalFiles = qFromLittleEndian<qint32>(c + idSize + 8);
+        mEntries[QByteArray(c, idSize)] = e;
+    }
+
+    return true;
+}
+
+bool StatsCache::flush()
+{
+    if (mUnsaved.isEmpty())
+        return true;
+
+    QDir().mkpath(QFileInfo(mFileName).path());
+
+    QFile f(mFileName);
+    const auto exists = f.exists();
+    if (!f.open(QFile::WriteOnly | QFile::Append))
+        return false;
+
+    if (!exists || f.size() == 0)
+        f.write(cacheMagic);
+
+    f.write(mUnsaved);
+    f.close();
+
+    mUnsaved.clear();
+    return true;
+}
+
+bool StatsCache::isEmpty() const
+{
+    return mEntries.isEmpty();
+}
+
+qint32 StatsCache::count() const
+{
+    return mEntries.count();
+}
+
+bool StatsCache::find(GitCommands::CommitStat &commit) const
+{
+    const auto it = mEntries.constFind(rawId(commit.commit.id));
+    if (it == mEntries.constEnd())
+        return false;
+
+    commit.insertions = it->insertions;
+    commit.deletions = it->deletions;
+    commit.totalFiles = it->totalFiles;
+    return true;
+}
+
+void StatsCache::insert(const GitCommands::CommitStat &commit)
+{
+    const auto id = rawId(commit.commit.id);
+    if (id.isEmpty() || mEntries.contains(id))
+        return;
+
+    Entry e;
+    e.insertions = commit.insertions;
+    e.deletions = commit.deletions;
+    e.totalFiles = commit.totalFiles;
+    mEntries[id] = e;
+
+    char values[valuesSize];
+    qToLittleEndian<qint32>(e.insertions, values);
+    qToLittleEndian<qint32>(e.deletions, values + 4);
+    qToLittleEndian<qint32>(e.totalFiles, values + 8);
+    mUnsaved.append(id);
+    mUnsaved.append(values, valuesSize);
+}
+
+QByteArray StatsCache::rawId(const QString &id) const
+{
+    const auto res = QByteArray::fromHex(id.toLatin1());
+    return res.size() == mIdSize? res : QByteArray();
+}
+
+QString StatsCache::fileName() const
+{
+    return mFileName;
+}
@@ -0,0 +1,51 @@
+#ifndef STATSCACHE_H
+#define STATSCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "gitcommands.h"
+
+/*!
+ * On-disk cache of per-commit stats of one repository. A commit's numstat
+ * never changes, so entries are keyed by the binary object id and the
+ * file is only ever appended to. Files live under the application cache
+ * directory, named after a hash of the repository path, of the options
+ * that change what a stat counts (e.g. path filters) and of the object id
+ * size of the repository's hash algorithm.
+ */
+class StatsCache
+{
+public:
+    StatsCache();
+    StatsCache(const QString &repositoryPath, const QString &fingerprint = QString(), qint32 idSize = 20);
+    virtual ~StatsCache();
+
+    bool load();
+    bool flush();
+
+    bool isEmpty() const;
+    qint32 count() const;
+
+    bool find(GitCommands::CommitStat &commit) const;
+    void insert(const GitCommands::CommitStat &commit);
+
+    QString fileName() const;
+
+private:
+    struct Entry {
+        qint32 insertions = 0;
+        qint32 deletions = 0;
+        qint32 totalFiles = 0;
+    };
+
+    QByteArray rawId(const QString &id) const;
+
+    QString mFileName;
+    qint32 mIdSize = 20;
+    QHash<QByteArray, Entry> mEntries;
+    QByteArray mUnsaved;
+};
+
+#endif // STATSCACHE_H
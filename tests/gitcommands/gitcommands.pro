@@ -0,0 +1,21 @@
+QT += testlib concurrent
+QT -= gui
+CONFIG += testcase console c++17
+CONFIG -= app_bundle
+
+TARGET = tst_gitcommands
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../commitgraph.cpp \
+    ../../gitcommands.cpp \
+    ../../gitlogparser.cpp \
+    ../../gitscheduler.cpp \
+    tst_gitcommands.cpp
+
+HEADERS += \
+    ../../commitgraph.h \
+    ../../gitcommands.h \
+    ../../gitlogparser.h \
+    ../../gitscheduler.h
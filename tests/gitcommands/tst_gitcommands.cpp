@@ -0,0 +1,199 @@
+#include "gitcommands.h"
+#include "gitlogparser.h"
+
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class GitCommandsTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void pathspecsKeepSideBranches();
+    void parserKeepsSubjectOnly();
+    void parserCountsBinaryFiles();
+    void parserJoinsSplitRecords();
+    void parserCountsStatusLines();
+
+private:
+    bool git(const QStringList &arguments, const QString &path = QString());
+    void listComments(GitCommands &commands, QStringList *comments, bool *done);
+
+    QTemporaryDir mRepository;
+};
+
+bool GitCommandsTest::git(const QStringList &arguments, const QString &path)
+{
+    QProcess p;
+    p.setWorkingDirectory(path.isEmpty()? mRepository.path() : path);
+    p.start(QStringLiteral("git"), QStringList() << QStringLiteral("-c") << QStringLiteral("user.name=Tester")
+                                                 << QStringLiteral("-c") << QStringLiteral("user.email=tester@example.com") << arguments);
+    return p.waitForFinished() && p.exitStatus() == QProcess::NormalExit && p.exitCode() == 0;
+}
+
+static bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly))
+        return false;
+
+    f.write(data);
+    return true;
+}
+
+void GitCommandsTest::listComments(GitCommands &commands, QStringList *comments, bool *done)
+{
+    GitCommands::LogOptions options;
+    options.revisions = QStringLiteral("HEAD");
+
+    commands.listCommits(options, [comments](const QList<GitCommands::Commit> &list){
+        for (const auto &c: list)
+            *comments << c.comment;
+    }, [done](bool){
+        *done = true;
+    });
+}
+
+void GitCommandsTest::initTestCase()
+{
+    // A side branch changes src/a and reverts it, then is merged. The merge
+    // leaves src/a as the main line had it.
+    QVERIFY(mRepository.isValid());
+    const QDir dir(mRepository.path());
+    QVERIFY(git({QStringLiteral("init"), QStringLiteral("-q")}));
+    QVERIFY(dir.mkdir(QStringLiteral("src")));
+
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("src/a")), "a\n"));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("b")), "b\n"));
+    QVERIFY(git({QStringLiteral("add"), QStringLiteral(".")}));
+    QVERIFY(git({QStringLiteral("commit"), QStringLiteral("-qm"), QStringLiteral("A")}));
+
+    QVERIFY(git({QStringLiteral("checkout"), QStringLiteral("-qb"), QStringLiteral("side")}));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("src/a")), "a2\n"));
+    QVERIFY(git({QStringLiteral("commit"), QStringLiteral("-qam"), QStringLiteral("S1")}));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("src/a")), "a\n"));
+    QVERIFY(git({QStringLiteral("commit"), QStringLiteral("-qam"), QStringLiteral("S2")}));
+
+    QVERIFY(git({QStringLiteral("checkout"), QStringLiteral("-q"), QStringLiteral("-")}));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("b")), "c\n"));
+    QVERIFY(git({QStringLiteral("commit"), QStringLiteral("-qam"), QStringLiteral("M1")}));
+    QVERIFY(git({QStringLiteral("merge"), QStringLiteral("-q"), QStringLiteral("--no-ff"), QStringLiteral("side"), QStringLiteral("-m"), QStringLiteral("Merge")}));
+}
+
+void GitCommandsTest::pathspecsKeepSideBranches()
+{
+    GitCommands commands(mRepository.path());
+
+    QStringList comments;
+    auto done = false;
+    listComments(commands, &comments, &done);
+    QTRY_VERIFY(done);
+    comments.sort();
+    QCOMPARE(comments, QStringList({QStringLiteral("A"), QStringLiteral("M1"), QStringLiteral("Merge"),
+                                    QStringLiteral("S1"), QStringLiteral("S2")}));
+
+    // Default history simplification would only keep A
+    comments.clear();
+    done = false;
+    commands.setPathspecs({QStringLiteral(":(glob)src/**")});
+    listComments(commands, &comments, &done);
+    QTRY_VERIFY(done);
+    comments.sort();
+    QCOMPARE(comments, QStringList({QStringLiteral("A"), QStringLiteral("S1"), QStringLiteral("S2")}));
+}
+
+static QByteArray record(const QByteArray &id, const QByteArray &subject, const QByteArray &lines)
+{
+    return "\x1e" + id + "\x1f" + "1700000000\x1f" + "Tester <tester@example.com>\x1f" + subject + "\n\n" + lines;
+}
+
+void GitCommandsTest::parserKeepsSubjectOnly()
+{
+    // Body lines never reach the parser, or they would count as files
+    QTemporaryDir repository;
+    QVERIFY(repository.isValid());
+    const QDir dir(repository.path());
+    QVERIFY(git({QStringLiteral("init"), QStringLiteral("-q")}, dir.path()));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("a")), "a\nb\n"));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("b")), "c\n"));
+    QVERIFY(git({QStringLiteral("add"), QStringLiteral(".")}, dir.path()));
+    QVERIFY(git({QStringLiteral("commit"), QStringLiteral("-qm"), QStringLiteral("Subject"),
+                 QStringLiteral("-m"), QStringLiteral("Body line\n1\t2\tnot-a-file\nM\tnot-a-file-either")}, dir.path()));
+
+    QProcess p;
+    p.setWorkingDirectory(dir.path());
+    p.start(QStringLiteral("git"), {QStringLiteral("log"), QStringLiteral("--numstat"), QStringLiteral("--format=") + GitLogParser::format()});
+    QVERIFY(p.waitForFinished());
+
+    GitLogParser parser;
+    parser.feed(p.readAllStandardOutput());
+    parser.finish();
+    const auto list = parser.take();
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.first().commit.comment, QStringLiteral("Subject"));
+    QCOMPARE(list.first().commit.commiter, QStringLiteral("Tester <tester@example.com>"));
+    QCOMPARE(list.first().totalFiles, 2);
+    QCOMPARE(list.first().insertions, 3);
+    QCOMPARE(list.first().deletions, 0);
+}
+
+void GitCommandsTest::parserCountsBinaryFiles()
+{
+    GitLogParser parser;
+    parser.feed(record("1234", "Binary", "-\t-\timage.png\n3\t1\ta.txt\n"));
+    parser.finish();
+    const auto list = parser.take();
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.first().totalFiles, 2);
+    QCOMPARE(list.first().insertions, 3);
+    QCOMPARE(list.first().deletions, 1);
+
+    const auto stats = GitLogParser::parseStats("-\t-\timage.png\n");
+    QCOMPARE(stats.count(), 1);
+    QCOMPARE(stats.first().fileName, QStringLiteral("image.png"));
+    QCOMPARE(stats.first().insertions, 0);
+    QCOMPARE(stats.first().deletions, 0);
+}
+
+void GitCommandsTest::parserJoinsSplitRecords()
+{
+    // A record is only parsed once the next one started, or at the end
+    const auto data = record("1234", "First", "1\t2\ta\n") + record("5678", "Second", "4\t0\tb\n10\t5\tc\n");
+
+    GitLogParser parser;
+    for (const auto c: data)
+        parser.feed(QByteArray(1, c));
+    QCOMPARE(parser.count(), 1);
+
+    parser.finish();
+    const auto list = parser.take();
+    QCOMPARE(list.count(), 2);
+    QCOMPARE(list.at(0).commit.id, QStringLiteral("1234"));
+    QCOMPARE(list.at(0).commit.comment, QStringLiteral("First"));
+    QCOMPARE(list.at(0).commit.datetime, QDateTime::fromSecsSinceEpoch(1700000000));
+    QCOMPARE(list.at(0).totalFiles, 1);
+    QCOMPARE(list.at(0).insertions, 1);
+    QCOMPARE(list.at(0).deletions, 2);
+    QCOMPARE(list.at(1).commit.id, QStringLiteral("5678"));
+    QCOMPARE(list.at(1).totalFiles, 2);
+    QCOMPARE(list.at(1).insertions, 14);
+    QCOMPARE(list.at(1).deletions, 5);
+}
+
+void GitCommandsTest::parserCountsStatusLines()
+{
+    // A rename is one status line with both names
+    GitLogParser parser;
+    parser.feed(record("1234", "Status", "M\ta\nR100\told\tnew\nA\tb c\n"));
+    parser.finish();
+    const auto list = parser.take();
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.first().totalFiles, 3);
+    QCOMPARE(list.first().insertions, 0);
+    QCOMPARE(list.first().deletions, 0);
+}
+
+QTEST_GUILESS_MAIN(GitCommandsTest)
+
+#include "tst_gitcommands.moc"
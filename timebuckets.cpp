@@ -0,0 +1,134 @@
+#include "timebuckets.h"
+
+#include <QTimeZone>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+const qint64 secsPerDay = 86400;
+const qint64 julianDayOfEpoch = 2440588;
+
+qint64 floorDiv(qint64 a, qint64 b)
+{
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+}
+
+TimeBuckets::TimeBuckets(AbstractChartWidget::Duration duration, qint64 from, qint64 to)
+    : mDuration(duration)
+{
+    const auto tz = QTimeZone::systemTimeZone();
+    mTransitions << std::numeric_limits<qint64>::min();
+    mOffsets << tz.offsetFromUtc(QDateTime::fromSecsSinceEpoch(from));
+    if (tz.hasTransitions() && from < to)
+        for (const auto &t: tz.transitions(QDateTime::fromSecsSinceEpoch(from), QDateTime::fromSecsSinceEpoch(to)))
+        {
+            mTransitions << t.atUtc.toSecsSinceEpoch();
+            mOffsets << t.offsetFromUtc;
+        }
+
+    // Years roll over on today's day of year, as the charts always did
+    const auto today = QDate::currentDate();
+    mYearShift = today.daysInYear() - today.dayOfYear();
+}
+
+TimeBuckets::~TimeBuckets()
+{
+
+}
+
+qint64 TimeBuckets::key(qint64 secs) const
+{
+    return dayKey(localDay(secs, offset(secs)));
+}
+
+qint64 TimeBuckets::dayKey(qint64 day) const
+{
+    qint32 year, month, dayOfMonth;
+    switch (static_cast<int>(mDuration))
+    {
+    case AbstractChartWidget::Week:
+        return floorDiv(day + julianDayOfEpoch, 7);
+    case AbstractChartWidget::Month:
+        civilDate(day, year, month, dayOfMonth);
+        return year * 12 + month - 1;
+    case AbstractChartWidget::Year:
+        civilDate(day + mYearShift, year, month, dayOfMonth);
+        return year;
+    }
+
+    return day;
+}
+
+qint64 TimeBuckets::firstDay(qint64 key) const
+{
+    switch (static_cast<int>(mDuration))
+    {
+    case AbstractChartWidget::Week:
+        return key * 7 - julianDayOfEpoch;
+    case AbstractChartWidget::Month:
+    {
+        const auto year = floorDiv(key, 12);
+        return daysFromCivil(year, key - year * 12 + 1, 1);
+    }
+    case AbstractChartWidget::Year:
+        return daysFromCivil(key, 1, 1) - mYearShift;
+    }
+
+    return key;
+}
+
+QDateTime TimeBuckets::date(qint64 key) const
+{
+    switch (static_cast<int>(mDuration))
+    {
+    case AbstractChartWidget::Week:
+        return QDateTime(QDate::fromJulianDay(key * 7 + 7), QTime(0,0,0));
+    case AbstractChartWidget::Month:
+    {
+        const auto year = floorDiv(key, 12);
+        return QDateTime(QDate(year, key - year * 12 + 1, 1).addMonths(1).addDays(-1), QTime(0,0,0));
+    }
+    case AbstractChartWidget::Year:
+        return QDateTime(QDate(key, 12, 31), QTime(0,0,0));
+    }
+
+    return QDateTime(QDate::fromJulianDay(key + julianDayOfEpoch), QTime(0,0,0));
+}
+
+qint64 TimeBuckets::localDay(qint64 secs, qint32 offset)
+{
+    return floorDiv(secs + offset, secsPerDay);
+}
+
+void TimeBuckets::civilDate(qint64 day, qint32 &year, qint32 &month, qint32 &dayOfMonth)
+{
+    // Days since 1970-01-01 to a proleptic Gregorian date, without any QDate
+    const auto z = day + 719468;
+    const auto era = floorDiv(z, 146097);
+    const auto doe = z - era * 146097;
+    const auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const auto mp = (5 * doy + 2) / 153;
+
+    dayOfMonth = static_cast<qint32>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<qint32>(mp < 10? mp + 3 : mp - 9);
+    year = static_cast<qint32>(yoe + era * 400 + (month <= 2? 1 : 0));
+}
+
+qint64 TimeBuckets::daysFromCivil(qint32 year, qint32 month, qint32 dayOfMonth)
+{
+    const qint64 y = year - (month <= 2? 1 : 0);
+    const auto era = floorDiv(y, 400);
+    const auto yoe = y - era * 400;
+    const auto doy = (153 * (month > 2? month - 3 : month + 9) + 2) / 5 + dayOfMonth - 1;
+    const auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+qint32 TimeBuckets::offset(qint64 secs) const
+{
+    const auto it = std::upper_bound(mTransitions.constBegin(), mTransitions.constEnd(), secs);
+    return mOffsets.at(static_cast<qint32>(it - mTransitions.constBegin()) - 1);
+}
@@ -0,0 +1,41 @@
+#ifndef TIMEBUCKETS_H
+#define TIMEBUCKETS_H
+
+#include <QDateTime>
+#include <QVector>
+
+#include "abstractchartwidget.h"
+
+/*!
+ * Maps epoch seconds to integer bucket keys of a chart duration: the
+ * local day number, the week number, year * 12 + month or the rolling
+ * year. Keys of consecutive buckets are consecutive integers, so values
+ * can be accumulated into plain arrays indexed by key - first key, and
+ * a QDateTime is only built once per resulting point by date().
+ * Local time offsets of the requested range are looked up once.
+ */
+class TimeBuckets
+{
+public:
+    TimeBuckets(AbstractChartWidget::Duration duration, qint64 from, qint64 to);
+    virtual ~TimeBuckets();
+
+    qint64 key(qint64 secs) const;
+    qint64 dayKey(qint64 day) const;
+    qint64 firstDay(qint64 key) const;
+    QDateTime date(qint64 key) const;
+
+    static qint64 localDay(qint64 secs, qint32 offset);
+    static void civilDate(qint64 day, qint32 &year, qint32 &month, qint32 &dayOfMonth);
+    static qint64 daysFromCivil(qint32 year, qint32 month, qint32 dayOfMonth);
+
+private:
+    qint32 offset(qint64 secs) const;
+
+    AbstractChartWidget::Duration mDuration;
+    qint64 mYearShift = 0;
+    QVector<qint64> mTransitions;
+    QVector<qint32> mOffsets;
+};
+
+#endif // TIMEBUCKETS_H